@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * allocator/numapartitionedallocator.hpp
+ *
+ * Allocator for NUMA-aware migrations. Unlike NUMAPoolAllocator (whose pool
+ * is interleaved over all nodes), every allocation is mapped separately and
+ * split into one contiguous part per node: the i-th part is bound to node i.
+ * Tables using this allocator (see partitions_by_node) hand out migration
+ * blocks per part, such that threads first migrate into node-local pages.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#ifndef NUMAPARTITIONEDALLOCATOR_H
+#define NUMAPARTITIONEDALLOCATOR_H
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "numa.h"
+
+namespace growt
+{
+
+template <class T = char>
+class NUMAPartitionedAllocator
+{
+  public:
+    using value_type      = T;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    //! C++11 type flag
+    using is_always_equal = std::true_type;
+    //! C++11 type flag
+    using propagate_on_container_move_assignment = std::true_type;
+
+    //! allocations are split into num_partitions() parts (one per node)
+    static constexpr bool partitions_by_node = true;
+
+    //! Return allocator for different type.
+    template <class U> struct rebind
+    {
+        using other = NUMAPartitionedAllocator<U>;
+    };
+
+    NUMAPartitionedAllocator() = default;
+    NUMAPartitionedAllocator(const NUMAPartitionedAllocator&) noexcept =
+        default;
+    template <class U>
+    NUMAPartitionedAllocator(const NUMAPartitionedAllocator<U>&) noexcept
+    {
+    }
+    NUMAPartitionedAllocator&
+    operator=(const NUMAPartitionedAllocator&) noexcept = default;
+
+    //! Node ids are used as partition indices (ids of unavailable nodes
+    //! get a part without binding)
+    static size_type num_partitions()
+    {
+        static const size_type parts =
+            (numa_available() < 0) ? 1 : size_type(numa_max_node()) + 1;
+        return parts;
+    }
+
+    //! Allocates memory for n objects of type T (the memory is not touched,
+    //! pages are placed on their node once they are initialized)
+    pointer allocate(size_type n, const void* /* hint */ = nullptr)
+    {
+        if (n > max_size()) throw std::bad_alloc();
+
+        auto  bytes  = n * sizeof(T);
+        char* memory = static_cast<char*>(numa_alloc(bytes));
+        if (!memory) throw std::bad_alloc();
+
+        auto parts = num_partitions();
+        if (parts > 1)
+        {
+            auto page = size_type(numa_pagesize());
+            auto part = (bytes / parts + page - 1) / page * page;
+            for (size_type i = 0; i < parts && i * part < bytes; ++i)
+            {
+                if (!numa_bitmask_isbitset(numa_all_nodes_ptr, i)) continue;
+                numa_tonode_memory(memory + i * part,
+                                   std::min(part, bytes - i * part), i);
+            }
+        }
+        return reinterpret_cast<pointer>(memory);
+    }
+
+    //! Frees an allocated piece of memory (the size is necessary)
+    void deallocate(pointer p, size_type n) noexcept
+    {
+        numa_free(p, n * sizeof(T));
+    }
+
+    //! Maximum size possible to allocate
+    size_type max_size() const noexcept { return size_t(-1) / sizeof(T); }
+
+    template <class Other>
+    bool operator==(const NUMAPartitionedAllocator<Other>&) const
+    {
+        return true;
+    }
+
+    template <class Other>
+    bool operator!=(const NUMAPartitionedAllocator<Other>&) const
+    {
+        return false;
+    }
+};
+
+} // namespace growt
+
+#endif // NUMAPARTITIONEDALLOCATOR_H
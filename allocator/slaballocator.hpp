@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * allocator/slaballocator.hpp
+ *
+ * Slab allocator with per thread free lists. Single objects are carved from
+ * large slabs using a thread local bump pointer; freed objects are pushed onto
+ * the free list of the freeing thread and reused by its next allocations.
+ * This is used for the key/value storage of complex slots, where each
+ * insertion allocates exactly one value_type.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifndef GROWT_SLAB_SIZE
+#define GROWT_SLAB_SIZE 1024ull * 1024ull
+#endif
+
+namespace growt
+{
+
+namespace _slab_arena
+{
+
+// One arena exists per chunk size/alignment. Each thread owns a free list and
+// a bump range inside its current slab, therefore allocate and deallocate do
+// not need any synchronization. Only fetching a new slab takes a lock.
+//
+// Slabs are never returned to the system. Objects can outlive threads (and
+// the tables can outlive static destruction), thus the global part is leaked
+// on purpose. When a thread ends, its free list and the rest of its bump range
+// are handed to the global orphan list, where other threads can adopt them.
+// Frees (and allocations) that run later during the exit of the thread (e.g.
+// from the destructor of another thread local) use the orphan list directly.
+//
+// Threads that free more than they allocate (e.g. a thread that erases or
+// updates elements inserted by others, see epoch_reclamation.hpp) hand their
+// free list to the orphan list once it holds a slab worth of chunks, such
+// that allocating threads adopt it instead of fetching new slabs.
+template <size_t Size, size_t Align, size_t SlabSize>
+class arena
+{
+  private:
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    static constexpr size_t chunk_align = std::max(Align, alignof(free_node));
+    static constexpr size_t chunk_size =
+        (std::max(Size, sizeof(free_node)) + chunk_align - 1) / chunk_align *
+        chunk_align;
+    static constexpr size_t alignment =
+        std::max(chunk_align, alignof(std::max_align_t));
+    static constexpr size_t slab_size =
+        (SlabSize + alignment - 1) / alignment * alignment;
+
+    static_assert(chunk_size <= slab_size,
+                  "slab is too small to hold a single element");
+
+    // maximum length of a thread local free list
+    static constexpr size_t max_local_free = slab_size / chunk_size;
+
+    // a list of free chunks (tail and count make handing it over O(1))
+    struct free_list_type
+    {
+        free_node* head  = nullptr;
+        free_node* tail  = nullptr;
+        size_t     count = 0;
+
+        void push(free_node* node)
+        {
+            node->next = head;
+            if (!head) tail = node;
+            head = node;
+            ++count;
+        }
+        free_node* pop()
+        {
+            auto node = head;
+            head      = node->next;
+            if (--count == 0) tail = nullptr;
+            return node;
+        }
+    };
+
+    struct global_data_type
+    {
+        std::mutex                  mutex;
+        std::vector<void*>          slabs;
+        std::vector<free_list_type> orphans;
+    };
+
+    static global_data_type& global()
+    {
+        static global_data_type* g = new global_data_type();
+        return *g;
+    }
+
+    static void hand_over(free_list_type& list)
+    {
+        if (!list.count) return;
+        auto&                       g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        g.orphans.push_back(list);
+        list = free_list_type();
+    }
+
+    struct local_data_type
+    {
+        free_list_type free_list;
+        char*          bump      = nullptr;
+        char*          bump_end  = nullptr;
+        bool           destroyed = false;
+
+        ~local_data_type()
+        {
+            destroyed = true;
+            for (; bump + chunk_size <= bump_end; bump += chunk_size)
+                free_list.push(reinterpret_cast<free_node*>(bump));
+            bump = bump_end = nullptr;
+            hand_over(free_list);
+        }
+    };
+
+    static inline thread_local local_data_type _local;
+
+    static void refill(local_data_type& l)
+    {
+        auto&                       g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        if (!g.orphans.empty())
+        {
+            l.free_list = g.orphans.back();
+            g.orphans.pop_back();
+            return;
+        }
+
+        auto slab = static_cast<char*>(std::aligned_alloc(alignment, slab_size));
+        if (!slab) throw std::bad_alloc();
+        g.slabs.push_back(slab);
+        l.bump     = slab;
+        l.bump_end = slab + slab_size;
+    }
+
+    // used after the thread local data was destroyed
+    static void* allocate_orphan()
+    {
+        {
+            auto&                       g = global();
+            std::lock_guard<std::mutex> lock(g.mutex);
+            if (!g.orphans.empty())
+            {
+                auto node = g.orphans.back().pop();
+                if (!g.orphans.back().count) g.orphans.pop_back();
+                return node;
+            }
+        }
+        auto ptr = std::aligned_alloc(
+            alignment, (chunk_size + alignment - 1) / alignment * alignment);
+        if (!ptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    static void deallocate_orphan(free_node* node)
+    {
+        auto&                       g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        if (g.orphans.empty() || g.orphans.back().count >= max_local_free)
+            g.orphans.emplace_back();
+        g.orphans.back().push(node);
+    }
+
+  public:
+    static void* allocate()
+    {
+        auto& l = _local;
+        if (l.destroyed) return allocate_orphan();
+        if (!l.free_list.count && l.bump + chunk_size > l.bump_end) refill(l);
+
+        if (l.free_list.count) return l.free_list.pop();
+        auto ptr = l.bump;
+        l.bump += chunk_size;
+        return ptr;
+    }
+
+    static void deallocate(void* ptr)
+    {
+        auto& l    = _local;
+        auto  node = static_cast<free_node*>(ptr);
+        if (l.destroyed) return deallocate_orphan(node);
+        l.free_list.push(node);
+        if (l.free_list.count >= max_local_free) hand_over(l.free_list);
+    }
+
+    // number of slabs fetched from the system (by all threads)
+    static size_t num_slabs()
+    {
+        auto&                       g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        return g.slabs.size();
+    }
+};
+
+} // namespace _slab_arena
+
+
+
+template <class T = char, size_t S = GROWT_SLAB_SIZE>
+class SlabAllocator
+{
+  private:
+    using arena_type = _slab_arena::arena<sizeof(T), alignof(T), S>;
+
+  public:
+    using value_type      = T;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    //! C++11 type flag
+    using is_always_equal = std::true_type;
+    //! C++11 type flag
+    using propagate_on_container_move_assignment = std::true_type;
+
+
+    //! Return allocator for different type.
+    template <class U> struct rebind
+    {
+        using other = SlabAllocator<U, S>;
+    };
+
+
+    SlabAllocator()                              = default;
+    SlabAllocator(const SlabAllocator&) noexcept = default;
+    template <class U> SlabAllocator(const SlabAllocator<U, S>&) noexcept {};
+    SlabAllocator& operator=(const SlabAllocator&) noexcept = default;
+    ~SlabAllocator() noexcept                               = default;
+
+
+    //! Allocates memory for n objects of type T
+    //! (only single objects are served from the thread local slab)
+    pointer allocate(size_type n, const void* /* hint */ = nullptr)
+    {
+        if (n == 1) return static_cast<pointer>(arena_type::allocate());
+        return std::allocator<T>().allocate(n);
+    }
+
+    //! Frees an allocated piece of memory
+    //! (single objects go to the free list of the calling thread)
+    void deallocate(pointer p, size_type n = 1) noexcept
+    {
+        if (n == 1)
+            arena_type::deallocate(p);
+        else
+            std::allocator<T>().deallocate(p, n);
+    }
+
+    //! Number of slabs of this allocator type (they are never freed)
+    static size_type num_slabs() { return arena_type::num_slabs(); }
+
+    //! Returns the address of x.
+    pointer address(reference x) const noexcept { return std::addressof(x); }
+
+    //! Returns the address of x.
+    const_pointer address(const_reference x) const noexcept
+    {
+        return std::addressof(x);
+    }
+
+    //! Constructs an element object on the location pointed by p.
+    template <typename SubType, typename... Args>
+    void construct(SubType* p, Args&&... args)
+    {
+        ::new ((void*)p) SubType(std::forward<Args>(args)...);
+    }
+
+    //! Destroys in-place the object pointed by p.
+    template <typename SubType> void destroy(SubType* p) const noexcept
+    {
+        p->~SubType();
+    }
+
+    template <class Other>
+    bool operator==(const SlabAllocator<Other, S>&) const noexcept
+    {
+        return true;
+    }
+
+    template <class Other>
+    bool operator!=(const SlabAllocator<Other, S>&) const noexcept
+    {
+        return false;
+    }
+};
+
+} // namespace growt
+
+#endif // SLAB_ALLOCATOR_H
@@ -13,20 +13,32 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <stdlib.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "utils/default_hash.hpp"
 // #include "utils/output.hpp"
 // namespace otm = utils_tm::out_tm;
 
 #include "data-structures/base_linear_iterator.hpp"
+#include "data-structures/epoch_reclamation.hpp"
+#include "data-structures/hash_batch.hpp"
+#include "data-structures/migration_scheduler.hpp"
 #include "data-structures/returnelement.hpp"
+#include "data-structures/table_health.hpp"
+#include "data-structures/table_stats.hpp"
+#include "data-structures/tag_group.hpp"
 #include "example/update_fcts.hpp"
 
 namespace growt
@@ -34,11 +46,15 @@ namespace growt
 
 
 template <class Slot,
-          class HashFct     = utils_tm::hash_tm::default_hash,
-          class Alloc       = std::allocator<typename Slot::atomic_slot_type>,
-          bool CyclicMap    = false,
-          bool CyclicProb   = true,
-          bool NeedsCleanup = true>
+          class HashFct = utils_tm::hash_tm::default_hash,
+          class Alloc   = std::allocator<typename Slot::atomic_slot_type>,
+          bool CyclicMap      = false,
+          bool CyclicProb     = true,
+          bool NeedsCleanup   = true,
+          bool TagProbing     = false,
+          bool BoundedProbing = false,
+          bool LookupFilter   = false,
+          bool CollectStats   = false>
 class base_linear_config
 {
   public:
@@ -51,13 +67,45 @@ class base_linear_config
     // reused) and slot needs cleanup
     static constexpr bool cleanup = NeedsCleanup && Slot::needs_cleanup;
 
+    // keeps one hash tag byte per slot, which are scanned in groups by
+    // find/insert (see tag_group.hpp)
+    static constexpr bool tag_probing = TagProbing;
+
+    // stores the maximum displacement of all elements with the same home slot
+    // (one byte per slot), unsuccessful finds stop once they pass it
+    // (elements are not reordered by their displacement)
+    static constexpr bool bounded_probing = BoundedProbing;
+
+    // keeps a blocked bloom filter (one word per 8 home slots) that is
+    // checked by finds before any slot is probed (absent keys)
+    static constexpr bool lookup_filter = LookupFilter;
+
+    // counts probes and CAS retries for the handle statistics (see
+    // table_stats.hpp)
+    static constexpr bool collect_stats = CollectStats;
+
+    // quotient slots (and complex slots with hmod::stored_hash) store only a
+    // part of the hash, the home slot is reconstructed from their position
+    // (see quotient_slot.hpp)
+    static constexpr bool needs_position = Slot::needs_position;
+    static_assert(!needs_position || !CyclicMap,
+                  "positioned slots need the top hash bits as home slot");
+
+    static constexpr size_t slot_min_capacity()
+    {
+        if constexpr (needs_position)
+            return Slot::min_capacity;
+        else
+            return 0;
+    }
+
     class mapper_type
     {
       private:
         // capacity is at least twice as large, as the inserted capacity
         static size_t compute_capacity(size_t desired_capacity)
         {
-            auto temp = 256u;
+            size_t temp = min_capacity >> 1;
             while (temp < desired_capacity) temp <<= 1;
             return temp << 1;
         }
@@ -74,26 +122,42 @@ class base_linear_config
         size_t _probe_helper;
         size_t _map_helper;
         size_t _grow_helper;
+        bool   _shrinking;
 
       public:
-        mapper_type() : _probe_helper(0), _map_helper(0) {}
+        mapper_type() : _probe_helper(0), _map_helper(0), _shrinking(false) {}
         mapper_type(size_t capacity);
-        mapper_type(size_t capacity, size_t grow_helper);
+        mapper_type(size_t capacity,
+                    size_t grow_helper,
+                    bool   shrinking = false);
 
         // size_t capacity;
 
         static constexpr bool   cyclic_mapping = CyclicMap;
         static constexpr bool   cyclic_probing = CyclicProb;
         static constexpr size_t lp_buffer      = 1024;
+        static constexpr size_t min_capacity =
+            std::max<size_t>(512, slot_min_capacity());
+        // a shrunk table is filled to at most this fraction
+        static constexpr double shrink_target_fill = 0.25;
 
         size_t total_slots() const;
         size_t addressable_slots() const;
         size_t bitmask() const;
         size_t grow_helper() const;
+        // shrinking targets are fully initialized on construction and filled
+        // with atomic insertions, since migrated clusters may overlap
+        bool shrinking() const { return _shrinking; }
 
         size_t      map(size_t hashed) const;
         size_t      remap(size_t hashed) const;
-        mapper_type resize(size_t inserted, size_t deleted);
+        // map(hashed) == hashed >> right_shift() (only without cyclic_mapping)
+        size_t      right_shift() const { return _map_helper; }
+        // the result has at least min_size addressable slots (used to reserve)
+        mapper_type resize(size_t inserted,
+                           size_t deleted,
+                           double min_fill_rate = 0.,
+                           size_t min_size      = 0);
     };
 };
 
@@ -119,9 +183,13 @@ class base_linear
     template <class>
     friend class estrat_sync;
     template <class>
+    friend class estrat_incremental;
+    template <class>
     friend class wstrat_user;
     template <class>
     friend class wstrat_pool;
+    template <class, bool>
+    friend class base_linear_iterator;
 
     // _parallel_init = false does not work with the asynchroneous variant
     static constexpr bool _parallel_init = true;
@@ -163,12 +231,28 @@ class base_linear
 
     using handle_type = this_type&;
 
+    // element type used by the batched operations
+    using batch_element_type = std::pair<key_type, mapped_type>;
+    // batches are hashed block by block, and the home cells of the next
+    // batch_prefetch_distance keys are prefetched while resolving one probe
+    static constexpr size_type batch_block_size        = 64;
+    static constexpr size_type batch_prefetch_distance = 8;
+
+    // protects out-of-line elements (complex_slot) during an operation,
+    // such that concurrently erased elements are not reclaimed
+    using reclamation_guard_type = epoch_guard<slot_config::needs_reclamation>;
+
   protected:
     using insert_return_intern = std::pair<iterator, ReturnCode>;
 
   public:
     base_linear(size_type size_ = 1 << 18);
-    base_linear(mapper_type mapper_, size_type version_);
+    // deferred_init: the slots are only initialized through initialize_slots
+    // (blockwise, before anything is inserted), afterwards elements are
+    // migrated with atomic insertions (see estrat_incremental.hpp)
+    base_linear(mapper_type mapper_,
+                size_type   version_,
+                bool        deferred_init_ = false);
 
     base_linear(const base_linear&)            = delete;
     base_linear& operator=(const base_linear&) = delete;
@@ -242,16 +326,67 @@ class base_linear
 
     size_type erase_if(const key_type& k, const mapped_type& d);
 
+    // BATCHED OPERATIONS (f(i, it) is called with the result for keys[i])
+    template <class F>
+    size_type find_batch(std::span<const key_type> keys, F f);
+    size_type insert_batch(std::span<const batch_element_type> elements);
+    template <class F, class... Types>
+    size_type
+    insert_or_update_batch(std::span<const batch_element_type> elements,
+                           F                                   f,
+                           Types&&... args);
+
     size_type migrate(this_type& target, size_type s, size_type e);
 
+    // PARALLEL BULK CONSTRUCTION (duplicate keys are only inserted once)
+    static base_linear build_from(std::span<const batch_element_type> elements,
+                                  size_type num_threads);
+
+    // IN-PLACE REMOVAL OF DELETED DUMMIES (blockwise like migrate, blocks
+    // have to be aligned to block_size) only safe while no other operation
+    // accesses the table (estrat_sync, estrat_async copies instead)
+    void      begin_purge(size_type block_size);
+    size_type purge(size_type s, size_type e);
+    void      end_purge();
+
   protected:
     atomic_slot_type* _table;
     // std::atomic_int*   _init_table;
-    mapper_type        _mapper;
-    size_type          _version;
-    std::atomic_size_t _current_copy_block;
-    hash_fct_type      _hash;
-    allocator_type     _allocator;
+    mapper_type         _mapper;
+    size_type           _version;
+    bool                _deferred_init;
+    migration_scheduler _copy_scheduler;
+    hash_fct_type       _hash;
+    allocator_type      _allocator;
+
+    // tables whose memory is split by node (see
+    // allocator/numapartitionedallocator.hpp) are migrated per node
+    static constexpr bool numa_partitioned = requires {
+        requires allocator_type::partitions_by_node;
+    };
+    static size_type copy_partitions()
+    {
+        if constexpr (numa_partitioned) return allocator_type::num_partitions();
+        return 1;
+    }
+
+    // start of each purge block (first empty slot), published by the block
+    // itself or by the thread whose last cluster overlaps the block
+    static constexpr size_type _purge_unknown = ~size_type(0);
+    std::unique_ptr<std::atomic_size_t[]> _purge_starts;
+    size_type                             _purge_block_size;
+    inline size_type purge_start(size_type s, size_type e);
+    inline void      publish_purge_starts(size_type e, size_type j);
+
+    // elements that insert_unsafe could not store (see displacement_overflow)
+    struct overflow_node
+    {
+        slot_type      slot;
+        overflow_node* next;
+    };
+    std::atomic<overflow_node*> _overflow{nullptr};
+    // an insertion failed, because its displacement could not be stored
+    std::atomic_bool _displacement_full{false};
 
 
     // size_type   _capacity;
@@ -262,7 +397,190 @@ class base_linear
                                atomic_slot_type>::value,
                   "Wrong allocator type given to base_linear!");
 
+    // TAG ARRAY (ONLY USED WITH hmod::tag_probing) ****************************
+    using atomic_tag_type    = typename tag_group::atomic_tag_type;
+    using tag_allocator_type = typename std::allocator_traits<
+        allocator_type>::template rebind_alloc<atomic_tag_type>;
+
+    atomic_tag_type*   _tags;
+    tag_allocator_type _tag_allocator;
+
     inline size_type h(const key_type& k) const { return _hash(k); }
+    // hash of an element that is moved into this table, slots that store
+    // their hash (slot_config::stores_hash) are only rehashed, if the known
+    // bits are not enough to place the element
+    inline size_type migration_hash(const slot_type& e) const
+    {
+        if constexpr (slot_config::stores_hash)
+        {
+            // tags and filter bits are computed from the whole hash
+            constexpr bool full = mapper_type::cyclic_mapping ||
+                                  config_type::tag_probing ||
+                                  config_type::lookup_filter;
+            size_type needed = (full) ? 64 : 64 - _mapper.right_shift();
+            if (e.hash_bits() >= needed) return e.get_hash();
+        }
+        return h(e.get_key());
+    }
+    // hashes[i] = h(key(i)) for i < n <= batch_block_size, the keys are
+    // gathered for hash functors with hash_batch (see hash_batch.hpp)
+    template <class KeyFct>
+    inline void h_batch(size_type n, KeyFct key, size_type* hashes) const
+    {
+        if constexpr (batch_hashable<hash_fct_type, key_type>)
+        {
+            key_type keys[batch_block_size] = {};
+            for (size_type i = 0; i < n; ++i) keys[i] = key(i);
+            _hash.hash_batch(keys, n, hashes);
+        }
+        else
+        {
+            for (size_type i = 0; i < n; ++i) hashes[i] = h(key(i));
+        }
+    }
+
+    static inline typename tag_group::tag_type make_tag(size_type hash)
+    {
+        return tag_group::make_tag<mapper_type::cyclic_mapping>(hash);
+    }
+    inline void set_tag(size_type pos, size_type hash)
+    {
+        if constexpr (config_type::tag_probing)
+            _tags[pos].store(make_tag(hash), std::memory_order_release);
+    }
+
+    // DISPLACEMENT BOUNDS (ONLY USED WITH hmod::bounded_probing) **************
+    // _bounds[p] is one larger than the maximum displacement of all elements
+    // with home slot p (0 = there is none, unbounded = search until empty)
+    using atomic_bound_type            = atomic_tag_type;
+    static constexpr uint8_t unbounded = 255;
+    atomic_bound_type*       _bounds;
+
+    // has to be called before the element becomes visible at home + disp
+    inline void raise_bound(size_type home, size_type disp)
+    {
+        if constexpr (!config_type::bounded_probing) return;
+        auto& bound = _bounds[home];
+        auto  nb    = uint8_t(std::min(disp + 1, size_type(unbounded)));
+        auto  cb    = bound.load(std::memory_order_relaxed);
+        while (cb < nb && !bound.compare_exchange_weak(
+                              cb, nb, std::memory_order_release,
+                              std::memory_order_relaxed))
+        { /* retry */
+        }
+    }
+    // finds with this home slot can stop at the returned (unmapped) index
+    inline size_type probe_limit(size_type home) const
+    {
+        if constexpr (!config_type::bounded_probing)
+            return std::numeric_limits<size_type>::max();
+        auto bound = _bounds[home].load(std::memory_order_acquire);
+        return (bound == unbounded) ? std::numeric_limits<size_type>::max()
+                                    : home + bound;
+    }
+
+    // LOOKUP FILTER (ONLY USED WITH hmod::lookup_filter) **********************
+    // blocked bloom filter, each key sets filter_hashes bits in the word of
+    // its home slot. Bits are never removed, erased keys stay in the filter
+    // until the next migration or purge (both rebuild it from the elements)
+    using atomic_filter_type    = std::atomic_uint64_t;
+    using filter_allocator_type = typename std::allocator_traits<
+        allocator_type>::template rebind_alloc<atomic_filter_type>;
+    static constexpr size_type filter_block  = 8;
+    static constexpr size_type filter_hashes = 3;
+
+    atomic_filter_type*   _filter;
+    filter_allocator_type _filter_allocator;
+
+    inline size_type filter_size() const
+    {
+        return (_mapper.addressable_slots() + filter_block - 1) / filter_block;
+    }
+    static inline uint64_t filter_mask(size_type hash)
+    {
+        // the home slot is taken from the hash, the bits are taken from a
+        // remixed hash to keep them independent from the block
+        uint64_t mix  = (hash ^ (hash >> 32)) * 0x9E3779B97F4A7C15ull;
+        uint64_t mask = 0;
+        for (size_type i = 1; i <= filter_hashes; ++i)
+            mask |= uint64_t(1) << ((mix >> (64 - 6 * i)) & 63);
+        return mask;
+    }
+    // has to be called before the element becomes visible
+    inline void filter_add(size_type hash)
+    {
+        if constexpr (!config_type::lookup_filter) return;
+        _filter[_mapper.map(hash) / filter_block].fetch_or(
+            filter_mask(hash), std::memory_order_release);
+    }
+    // false iff no element with this hash was ever inserted into this table
+    inline bool filter_contains(size_type hash) const
+    {
+        if constexpr (!config_type::lookup_filter) return true;
+        auto mask = filter_mask(hash);
+        return (_filter[_mapper.map(hash) / filter_block].load(
+                    std::memory_order_acquire) &
+                mask) == mask;
+    }
+
+    // POSITIONED SLOT ACCESS **************************************************
+    // quotient slots (config_type::needs_position) are encoded/decoded using
+    // their position, all other slots are accessed directly. Loads and failed
+    // CAS operations are counted for the handle statistics (table_stats.hpp).
+    static inline void count_retry()
+    {
+        if constexpr (config_type::collect_stats)
+            ++this_thread_stats.cas_retries;
+    }
+    inline slot_type load_slot(size_type pos) const
+    {
+        if constexpr (config_type::collect_stats) ++this_thread_stats.probes;
+        if constexpr (config_type::needs_position)
+            return _table[pos].load(pos, _mapper);
+        else
+            return _table[pos].load();
+    }
+    inline bool
+    cas_slot(size_type pos, slot_type& expected, const slot_type& goal)
+    {
+        bool success;
+        if constexpr (config_type::needs_position)
+            success = _table[pos].cas(expected, goal, pos, _mapper);
+        else
+            success = _table[pos].cas(expected, goal);
+        if (!success) count_retry();
+        return success;
+    }
+    inline void set_slot(size_type pos, const slot_type& goal)
+    {
+        if constexpr (config_type::needs_position)
+            _table[pos].non_atomic_set(goal, pos, _mapper);
+        else
+            _table[pos].non_atomic_set(goal);
+    }
+    template <class F, class... Types>
+    inline std::pair<slot_type, bool>
+    non_atomic_update_slot(size_type pos, F f, Types&&... args)
+    {
+        if constexpr (config_type::needs_position)
+            return _table[pos].non_atomic_update_at(
+                pos, _mapper, f, std::forward<Types>(args)...);
+        else
+            return _table[pos].non_atomic_update(f,
+                                                 std::forward<Types>(args)...);
+    }
+    // quotient slots can only encode displacements up to max_displacement
+    inline bool displacement_fits([[maybe_unused]] size_type disp) const
+    {
+        if constexpr (config_type::needs_position)
+            return disp <= slot_config::max_displacement;
+        else
+            return true;
+    }
+
+    // allocates/initializes the tag, bound, and filter arrays (if used)
+    inline void allocate_meta();
+    inline void initialize_meta(size_type start, size_type end);
     // inline size_type map  (const size_type & hashed) const
     // { return hashed >> _right_shift; }
     // inline size_type remap(const size_type & hashed) const
@@ -275,6 +593,25 @@ class base_linear
 
   protected:
     insert_return_intern insert_intern(const slot_type& slot, size_type hash);
+    insert_return_intern tag_insert_intern(const slot_type& slot,
+                                           size_type        hash);
+    atomic_slot_type*
+    tag_find_intern(const key_type& k, size_type hash, slot_type& res) const;
+    iterator find_intern(const key_type& k, size_type hash);
+
+    template <bool Write = false>
+    inline void prefetch(size_type hash) const
+    {
+        auto pos = _mapper.remap(_mapper.map(hash));
+        if constexpr (config_type::tag_probing)
+            __builtin_prefetch(_tags + pos, Write, 3);
+        if constexpr (config_type::bounded_probing)
+            __builtin_prefetch(_bounds + pos, Write, 3);
+        if constexpr (config_type::lookup_filter)
+            __builtin_prefetch(_filter + _mapper.map(hash) / filter_block,
+                               Write, 3);
+        __builtin_prefetch(_table + pos, Write, 3);
+    }
     ReturnCode           erase_intern(const key_type& k);
     ReturnCode erase_if_intern(const key_type& k, const mapped_type& d);
 
@@ -310,13 +647,14 @@ class base_linear
 
     inline iterator make_iterator(const slot_type& slot, atomic_slot_type* ptr)
     {
-        return iterator(slot, ptr, _table + _mapper.total_slots());
+        return iterator(slot, ptr, _table + _mapper.total_slots(), this);
     }
 
     inline const_iterator
     make_citerator(const slot_type& slot, atomic_slot_type* ptr) const
     {
-        return const_iterator(slot, ptr, _table + _mapper.total_slots());
+        return const_iterator(slot, ptr, _table + _mapper.total_slots(),
+                              this);
     }
 
     inline insert_return_type
@@ -349,7 +687,35 @@ class base_linear
 
     void        initialize(size_t start, size_t end);
     void        initialize(size_t idx);
+    // initializes the slots [start, end) of a table with deferred_init,
+    // start has to be a multiple of filter_block
+    void        initialize_slots(size_type start, size_type end);
+    // migrated elements are inserted with CAS, if the target is shared with
+    // other migrated blocks (shrinking) or with concurrent operations
+    bool        atomic_fill() const
+    {
+        return _deferred_init || _mapper.shrinking();
+    }
+    // finds the start of the cluster containing the home slot of hash (the
+    // preceding empty slot, or 0 without cyclic probing), returns true if
+    // that slot is marked, i.e., the cluster is claimed by the migration of
+    // the block containing start (migrate copies whole clusters)
+    bool marked_cluster_start(size_type hash, size_type& start) const;
     void        insert_unsafe(const slot_type& e);
+    void        insert_unsafe(const slot_type& e, size_type hash);
+    // insert_unsafe keeps elements aside, whose displacement cannot be stored
+    // (see quotient_slot::max_displacement). Such a migration target has to
+    // be replaced by a larger one (migrate_overflowed) before it is used.
+    bool        displacement_overflow() const;
+    mapper_type overflow_mapper() const;
+    void        migrate_overflowed(this_type& target) const;
+    // the next migration has to grow the table, if an insertion failed,
+    // because its displacement could not be stored (passed as min_size to
+    // mapper_type::resize)
+    size_type   min_migration_size() const;
+    // the table must not be accessed concurrently (not even by finds)
+    size_type bulk_insert_unsafe(std::span<const batch_element_type> elements,
+                                 size_type num_threads);
     inline void slot_cleanup() // called, either by the destructor, or by the
                                // destructor of the parenttable
     {
@@ -368,6 +734,36 @@ class base_linear
     inline const_range_iterator range_cend() const { return cend(); }
     inline size_t capacity() const { return _mapper.total_slots(); }
 
+    // bytes used by the lookup filter (0 without hmod::lookup_filter)
+    inline size_t filter_memory() const
+    {
+        if constexpr (!config_type::lookup_filter) return 0;
+        return filter_size() * sizeof(atomic_filter_type);
+    }
+    // estimated probability that a find for an absent key passes the filter
+    // (average over all filter words, since keys are spread uniformly)
+    double filter_false_positive_rate() const
+    {
+        if constexpr (!config_type::lookup_filter) return 1.;
+        double sum = 0.;
+        for (size_type i = 0; i < filter_size(); ++i)
+        {
+            auto   bits = __builtin_popcountll(
+                _filter[i].load(std::memory_order_relaxed));
+            double fill = double(bits) / 64.;
+            double prob = 1.;
+            for (size_type j = 0; j < filter_hashes; ++j) prob *= fill;
+            sum += prob;
+        }
+        return sum / double(filter_size());
+    }
+
+    // scans all slots for cluster, displacement, and tombstone statistics
+    // (see table_health.hpp), blocks of block_size slots are distributed
+    // round robin to num_threads threads
+    table_health health(size_type num_threads = 1,
+                        size_type block_size  = 4096) const;
+
     static std::string name()
     {
         std::stringstream name;
@@ -377,9 +773,14 @@ class base_linear
         else
             name << "lmap,";
         if constexpr (mapper_type::cyclic_probing)
-            name << "cprob>";
+            name << "cprob";
         else
-            name << "lprob>";
+            name << "lprob";
+        if constexpr (config_type::tag_probing) name << ",tags";
+        if constexpr (config_type::bounded_probing) name << ",bound";
+        if constexpr (config_type::lookup_filter) name << ",filter";
+        if constexpr (config_type::collect_stats) name << ",stats";
+        name << ">";
         return name.str();
     }
 };
@@ -395,7 +796,9 @@ class base_linear
 
 template <class C>
 base_linear<C>::base_linear(size_type capacity_)
-    : _mapper(capacity_), _version(0), _current_copy_block(0)
+    : _mapper(capacity_), _version(0), _deferred_init(false),
+      _copy_scheduler(_mapper.addressable_slots(), copy_partitions()),
+      _tags(nullptr), _bounds(nullptr), _filter(nullptr)
 {
     // _table =
     // static_cast<atomic_slot_type*>(malloc(sizeof(atomic_slot_type)*_mapper.capacity+1000));
@@ -408,12 +811,19 @@ base_linear<C>::base_linear(size_type capacity_)
     // std::endl;
 
     std::fill(_table, _table + nslots, slot_config::get_empty());
+
+    allocate_meta();
+    initialize_meta(0, nslots);
 }
 
 /*should always be called with a capacity_=2^k  */
 template <class C>
-base_linear<C>::base_linear(mapper_type mapper_, size_type version_)
-    : _mapper(mapper_), _version(version_), _current_copy_block(0)
+base_linear<C>::base_linear(mapper_type mapper_,
+                            size_type   version_,
+                            bool        deferred_init_)
+    : _mapper(mapper_), _version(version_), _deferred_init(deferred_init_),
+      _copy_scheduler(_mapper.addressable_slots(), copy_partitions()),
+      _tags(nullptr), _bounds(nullptr), _filter(nullptr)
 {
     // _table =
     // static_cast<atomic_slot_type*>(malloc(sizeof(atomic_slot_type)*_mapper.capacity+1000));
@@ -424,16 +834,21 @@ base_linear<C>::base_linear(mapper_type mapper_, size_type version_)
     // otm::buffered_out() << "(allocated ver " << version_ << " ptr " << _table
     // << ")" << std::endl;
 
+    allocate_meta();
+
     /* The table is initialized in parallel, during the migration */
-    if constexpr (!_parallel_init)
+    if (_deferred_init) return;
+    if (!_parallel_init || _mapper.shrinking())
     {
         std::fill(_table, _table + _mapper.total_slots(),
                   slot_config::get_empty());
+        initialize_meta(0, _mapper.total_slots());
     }
-    else if constexpr (!mapper_type::cyclic_probing)
+    else if (!mapper_type::cyclic_probing)
     {
         std::fill(_table + _mapper.addressable_slots(),
                   _table + _mapper.total_slots(), slot_config::get_empty());
+        initialize_meta(_mapper.addressable_slots(), _mapper.total_slots());
     }
 }
 
@@ -447,18 +862,72 @@ base_linear<C>::~base_linear()
     // _table << ")" << std::endl;
 
     if (_table) _allocator.deallocate(_table, _mapper.total_slots());
+    if (_tags)
+        _tag_allocator.deallocate(_tags,
+                                  _mapper.total_slots() + tag_group::width);
+    if (_bounds) _tag_allocator.deallocate(_bounds, _mapper.total_slots());
+    if (_filter) _filter_allocator.deallocate(_filter, filter_size());
+    for (auto node = _overflow.load(); node;)
+    {
+        auto next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+template <class C>
+inline void base_linear<C>::allocate_meta()
+{
+    if constexpr (config_type::tag_probing)
+    {
+        // the tag array is padded, such that each group load stays in bounds
+        auto ntags = _mapper.total_slots() + tag_group::width;
+        _tags      = _tag_allocator.allocate(ntags);
+        if (!_tags) throw std::bad_alloc();
+        std::fill(_tags + _mapper.total_slots(), _tags + ntags,
+                  tag_group::empty_tag);
+    }
+    if constexpr (config_type::bounded_probing)
+    {
+        _bounds = _tag_allocator.allocate(_mapper.total_slots());
+        if (!_bounds) throw std::bad_alloc();
+    }
+    if constexpr (config_type::lookup_filter)
+    {
+        // one filter word covers the home slots of different migration blocks
+        // therefore, it is cleared here instead of in initialize_meta
+        // (deferred tables clear it in initialize_slots)
+        _filter = _filter_allocator.allocate(filter_size());
+        if (!_filter) throw std::bad_alloc();
+        if (!_deferred_init) std::fill(_filter, _filter + filter_size(), 0);
+    }
+}
+
+template <class C>
+inline void base_linear<C>::initialize_meta(size_type start, size_type end)
+{
+    if constexpr (config_type::tag_probing)
+        std::fill(_tags + start, _tags + end, tag_group::empty_tag);
+    if constexpr (config_type::bounded_probing)
+        std::fill(_bounds + start, _bounds + end, 0);
 }
 
 
 template <class C>
 base_linear<C>::base_linear(base_linear&& rhs) noexcept
     : _table(nullptr), _mapper(rhs._mapper), _version(rhs._version),
-      _current_copy_block(0)
+      _deferred_init(rhs._deferred_init),
+      _copy_scheduler(_mapper.addressable_slots(), copy_partitions()),
+      _tags(nullptr), _bounds(nullptr), _filter(nullptr)
 {
-    if (rhs._current_copy_block.load())
+    if (rhs._copy_scheduler.started())
         std::invalid_argument("Cannot move a growing table!");
     rhs._mapper = mapper_type();
     std::swap(_table, rhs._table);
+    std::swap(_tags, rhs._tags);
+    std::swap(_bounds, rhs._bounds);
+    std::swap(_filter, rhs._filter);
+    _overflow.store(rhs._overflow.exchange(nullptr));
 }
 
 template <class C>
@@ -484,7 +953,7 @@ inline typename base_linear<C>::iterator base_linear<C>::begin()
 {
     for (size_t i = 0; i < _mapper.total_slots(); ++i)
     {
-        auto temp = _table[i].load();
+        auto temp = load_slot(i);
         if (!temp.is_empty() && !temp.is_deleted())
             return make_iterator(temp, &_table[i]);
     }
@@ -503,7 +972,7 @@ inline typename base_linear<C>::const_iterator base_linear<C>::cbegin() const
 {
     for (size_t i = 0; i < _mapper.total_slots(); ++i)
     {
-        auto temp = _table[i].load();
+        auto temp = load_slot(i);
         if (!temp.is_empty() && !temp.is_deleted())
             return make_citerator(temp, &_table[i]);
     }
@@ -526,9 +995,9 @@ base_linear<C>::range(size_t rstart, size_t rend)
     auto temp_rend = std::min(rend, _mapper.total_slots());
     for (size_t i = rstart; i < temp_rend; ++i)
     {
-        auto temp = _table[i].load();
+        auto temp = load_slot(i);
         if (!temp.is_empty() && !temp.is_deleted())
-            return range_iterator(temp, &_table[i], &_table[temp_rend]);
+            return range_iterator(temp, &_table[i], &_table[temp_rend], this);
     }
     return range_end();
 }
@@ -540,11 +1009,11 @@ base_linear<C>::crange(size_t rstart, size_t rend)
     auto temp_rend = std::min(rend, _mapper.total_slots());
     for (size_t i = rstart; i < temp_rend; ++i)
     {
-        auto temp = _table[i].load();
+        auto temp = load_slot(i);
         if (!temp.is_empty() && !temp.is_deleted())
             return const_range_iterator(
                 std::make_pair(temp.get_key(), temp.get_mapped()), &_table[i],
-                &_table[temp_rend]);
+                &_table[temp_rend], this);
     }
     return range_cend();
 }
@@ -557,12 +1026,15 @@ template <class C>
 inline typename base_linear<C>::insert_return_intern
 base_linear<C>::insert_intern(const slot_type& slot, size_type hash)
 {
+    if constexpr (config_type::tag_probing)
+        return tag_insert_intern(slot, hash);
+
     const key_type& key = slot.get_key_ref();
 
     for (size_type i = _mapper.map(hash);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
 
         if (curr.is_marked())
         {
@@ -575,9 +1047,16 @@ base_linear<C>::insert_intern(const slot_type& slot, size_type hash)
                 if (temp > _mapper.addressable_slots() + 300)
                     return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
             }
-            if (_table[temp].cas(curr, slot))
+            if (!displacement_fits(i - _mapper.map(hash)))
             {
-                return make_insert_ret(curr, &_table[temp],
+                _displacement_full.store(true, std::memory_order_relaxed);
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+            }
+            raise_bound(_mapper.map(hash), i - _mapper.map(hash));
+            filter_add(hash);
+            if (cas_slot(temp, curr, slot))
+            {
+                return make_insert_ret(slot, &_table[temp],
                                        ReturnCode::SUCCESS_IN);
             }
             // somebody changed the current element! recheck it
@@ -601,6 +1080,115 @@ base_linear<C>::insert_intern(const slot_type& slot, size_type hash)
     return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
 }
 
+// Group probing variants (hmod::tag_probing). The tags are only hints, the
+// slots stay authoritative. A tag is written after its slot, therefore, an
+// empty tag is confirmed by loading the slot, before a search is terminated.
+template <class C>
+inline typename base_linear<C>::insert_return_intern
+base_linear<C>::tag_insert_intern(const slot_type& slot, size_type hash)
+{
+    const key_type& key   = slot.get_key_ref();
+    const auto      tag   = make_tag(hash);
+    const auto      total = _mapper.total_slots();
+
+    for (size_type i = _mapper.map(hash);;)
+    {
+        size_type pos = _mapper.remap(i);
+        if (pos >= total) break;
+        size_type n = std::min(tag_group::width, total - pos);
+
+        auto group = tag_group(_tags + pos);
+        auto valid = (n == tag_group::width)
+                         ? ~typename tag_group::mask_type(0)
+                         : (typename tag_group::mask_type(1) << n) - 1;
+        auto cand  = (group.match(tag) | group.match_empty()) & valid;
+
+        while (cand)
+        {
+            size_type temp = pos + __builtin_ctz(cand);
+            auto      curr = load_slot(temp);
+
+            if (curr.is_marked())
+            {
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+            }
+            else if (curr.is_empty())
+            {
+                if constexpr (!mapper_type::cyclic_probing)
+                {
+                    if (temp > _mapper.addressable_slots() + 300)
+                        return make_insert_ret(end(),
+                                               ReturnCode::UNSUCCESS_FULL);
+                }
+                if (!displacement_fits(i + (temp - pos) - _mapper.map(hash)))
+                {
+                    _displacement_full.store(true, std::memory_order_relaxed);
+                    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+                }
+                raise_bound(_mapper.map(hash),
+                            i + (temp - pos) - _mapper.map(hash));
+                filter_add(hash);
+                if (cas_slot(temp, curr, slot))
+                {
+                    set_tag(temp, hash);
+                    return make_insert_ret(slot, &_table[temp],
+                                           ReturnCode::SUCCESS_IN);
+                }
+                // somebody changed the current element! recheck it
+                continue;
+            }
+            else if (curr.compare_key(key, hash))
+            {
+                return make_insert_ret(curr, &_table[temp],
+                                       ReturnCode::UNSUCCESS_ALREADY_USED);
+            }
+            cand &= cand - 1;
+        }
+        i += n;
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template <class C>
+inline typename base_linear<C>::atomic_slot_type*
+base_linear<C>::tag_find_intern(const key_type& k,
+                                size_type       hash,
+                                slot_type&      res) const
+{
+    const auto tag   = make_tag(hash);
+    const auto total = _mapper.total_slots();
+    const auto limit = probe_limit(_mapper.map(hash));
+
+    for (size_type i = _mapper.map(hash); i < limit;)
+    {
+        size_type pos = _mapper.remap(i);
+        if (pos >= total) break;
+        size_type n = std::min(tag_group::width, total - pos);
+
+        auto group = tag_group(_tags + pos);
+        auto valid = (n == tag_group::width)
+                         ? ~typename tag_group::mask_type(0)
+                         : (typename tag_group::mask_type(1) << n) - 1;
+        auto cand  = (group.match(tag) | group.match_empty()) & valid;
+
+        while (cand)
+        {
+            size_type temp = pos + __builtin_ctz(cand);
+            if (i + (temp - pos) >= limit) return nullptr;
+            auto curr = load_slot(temp);
+            if (curr.is_empty()) return nullptr;
+            if (curr.compare_key(k, hash))
+            {
+                res = curr;
+                return &_table[temp];
+            }
+            cand &= cand - 1;
+        }
+        i += n;
+    }
+    return nullptr;
+}
+
 template <class C>
 template <class F, class... Types>
 inline typename base_linear<C>::insert_return_intern
@@ -611,7 +1199,7 @@ base_linear<C>::update_intern(const key_type& k, F f, Types&&... args)
     for (size_type i = _mapper.map(htemp);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked())
         {
             return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
@@ -629,6 +1217,7 @@ base_linear<C>::update_intern(const key_type& k, F f, Types&&... args)
             if (succ)
                 return make_insert_ret(data, &_table[temp],
                                        ReturnCode::SUCCESS_UP);
+            count_retry();
             i--;
         }
         else if (curr.is_deleted())
@@ -652,7 +1241,7 @@ base_linear<C>::update_with_backoff_intern(const key_type& k,
     for (size_type i = _mapper.map(htemp);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked())
         {
             return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
@@ -670,6 +1259,7 @@ base_linear<C>::update_with_backoff_intern(const key_type& k,
             if (succ)
                 return make_insert_ret(data, &_table[temp],
                                        ReturnCode::SUCCESS_UP);
+            count_retry();
             if (!b(std::forward<Types>(args)...))
                 return make_insert_ret(end(), ReturnCode::UNSUCCESS_BACKOFF);
             i--;
@@ -692,7 +1282,7 @@ base_linear<C>::update_unsafe_intern(const key_type& k, F f, Types&&... args)
     for (size_type i = _mapper.map(htemp);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked())
         {
             return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
@@ -706,7 +1296,7 @@ base_linear<C>::update_unsafe_intern(const key_type& k, F f, Types&&... args)
             slot_type data = slot_config::get_empty();
             bool      succ;
             std::tie(data, succ) =
-                _table[temp].non_atomic_update(f, std::forward<Types>(args)...);
+                non_atomic_update_slot(temp, f, std::forward<Types>(args)...);
             if (succ)
                 return make_insert_ret(data, &_table[temp],
                                        ReturnCode::SUCCESS_UP);
@@ -734,7 +1324,7 @@ base_linear<C>::insert_or_update_intern(const slot_type& slot,
     for (size_type i = _mapper.map(hash);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked())
         {
             return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
@@ -746,9 +1336,19 @@ base_linear<C>::insert_or_update_intern(const slot_type& slot,
                 if (temp > _mapper.addressable_slots() + 300)
                     return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
             }
-            if (_table[temp].cas(curr, slot))
+            if (!displacement_fits(i - _mapper.map(hash)))
+            {
+                _displacement_full.store(true, std::memory_order_relaxed);
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+            }
+            raise_bound(_mapper.map(hash), i - _mapper.map(hash));
+            filter_add(hash);
+            if (cas_slot(temp, curr, slot))
+            {
+                set_tag(temp, hash);
                 return make_insert_ret(slot, &_table[temp],
                                        ReturnCode::SUCCESS_IN);
+            }
 
             // somebody changed the current element! recheck it
             --i;
@@ -762,6 +1362,7 @@ base_linear<C>::insert_or_update_intern(const slot_type& slot,
             if (succ)
                 return make_insert_ret(data, &_table[temp],
                                        ReturnCode::SUCCESS_UP);
+            count_retry();
             i--;
         }
         else if (curr.is_deleted())
@@ -785,7 +1386,7 @@ base_linear<C>::insert_or_update_unsafe_intern(const slot_type& slot,
     for (size_type i = _mapper.map(hash);; ++i) // i < hash+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked())
         {
             return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
@@ -797,9 +1398,19 @@ base_linear<C>::insert_or_update_unsafe_intern(const slot_type& slot,
                 if (temp > _mapper.addressable_slots() + 300)
                     return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
             }
-            if (_table[temp].cas(curr, slot))
+            if (!displacement_fits(i - _mapper.map(hash)))
+            {
+                _displacement_full.store(true, std::memory_order_relaxed);
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+            }
+            raise_bound(_mapper.map(hash), i - _mapper.map(hash));
+            filter_add(hash);
+            if (cas_slot(temp, curr, slot))
+            {
+                set_tag(temp, hash);
                 return make_insert_ret(slot, &_table[temp],
                                        ReturnCode::SUCCESS_IN);
+            }
             // somebody changed the current element! recheck it
             --i;
         }
@@ -808,7 +1419,7 @@ base_linear<C>::insert_or_update_unsafe_intern(const slot_type& slot,
             slot_type data = slot_config::get_empty();
             bool      succ;
             std::tie(data, succ) =
-                _table[temp].non_atomic_update(f, std::forward<Types>(args)...);
+                non_atomic_update_slot(temp, f, std::forward<Types>(args)...);
             if (succ)
                 return make_insert_ret(data, &_table[temp],
                                        ReturnCode::SUCCESS_UP);
@@ -830,7 +1441,7 @@ inline ReturnCode base_linear<C>::erase_intern(const key_type& k)
     for (size_type i = _mapper.map(htemp);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked()) { return ReturnCode::UNSUCCESS_INVALID; }
         else if (curr.is_empty()) { return ReturnCode::UNSUCCESS_NOT_FOUND; }
         else if (curr.compare_key(k, htemp))
@@ -839,6 +1450,7 @@ inline ReturnCode base_linear<C>::erase_intern(const key_type& k)
             {
                 return ReturnCode::SUCCESS_DEL;
             }
+            count_retry();
             i--;
         }
         else if (curr.is_deleted())
@@ -858,7 +1470,7 @@ base_linear<C>::erase_if_intern(const key_type& k, const mapped_type& d)
     for (size_type i = _mapper.map(htemp);; ++i) // i < htemp+MaDis
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
         if (curr.is_marked()) { return ReturnCode::UNSUCCESS_INVALID; }
         else if (curr.is_empty()) { return ReturnCode::UNSUCCESS_NOT_FOUND; }
         else if (curr.compare_key(k, htemp))
@@ -867,6 +1479,7 @@ base_linear<C>::erase_if_intern(const key_type& k, const mapped_type& d)
 
             if (_table[temp].atomic_delete(curr))
                 return ReturnCode::SUCCESS_DEL;
+            count_retry();
             i--;
         }
         else if (curr.is_deleted())
@@ -887,11 +1500,27 @@ base_linear<C>::erase_if_intern(const key_type& k, const mapped_type& d)
 template <class C>
 inline typename base_linear<C>::iterator base_linear<C>::find(const key_type& k)
 {
-    size_type htemp = h(k);
-    for (size_type i = _mapper.map(htemp);; ++i)
+    [[maybe_unused]] reclamation_guard_type guard;
+    return find_intern(k, h(k));
+}
+
+template <class C>
+inline typename base_linear<C>::iterator
+base_linear<C>::find_intern(const key_type& k, size_type htemp)
+{
+    if (!filter_contains(htemp)) return end();
+    if constexpr (config_type::tag_probing)
+    {
+        auto curr = slot_config::get_empty();
+        auto ptr  = tag_find_intern(k, htemp, curr);
+        return (ptr) ? make_iterator(curr, ptr) : end();
+    }
+    const size_type home  = _mapper.map(htemp);
+    const size_type limit = probe_limit(home);
+    for (size_type i = home; i < limit; ++i)
     {
         auto temp = _mapper.remap(i);
-        auto curr = _table[temp].load();
+        auto curr = load_slot(temp);
         if (curr.is_empty()) return end();
         if (curr.compare_key(k, htemp))
             return make_iterator(curr, &_table[temp]);
@@ -903,11 +1532,21 @@ template <class C>
 inline typename base_linear<C>::const_iterator
 base_linear<C>::find(const key_type& k) const
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     size_type htemp = h(k);
-    for (size_type i = _mapper.map(htemp);; ++i)
+    if (!filter_contains(htemp)) return cend();
+    if constexpr (config_type::tag_probing)
+    {
+        auto curr = slot_config::get_empty();
+        auto ptr  = tag_find_intern(k, htemp, curr);
+        return (ptr) ? make_citerator(curr, ptr) : cend();
+    }
+    const size_type home  = _mapper.map(htemp);
+    const size_type limit = probe_limit(home);
+    for (size_type i = home; i < limit; ++i)
     {
         auto temp = _mapper.remap(i);
-        auto curr = _table[temp].load();
+        auto curr = load_slot(temp);
         if (curr.is_empty()) return cend();
         if (curr.compare_key(k, htemp))
             return make_citerator(curr, &_table[temp]);
@@ -919,6 +1558,7 @@ template <class C>
 inline typename base_linear<C>::insert_return_type
 base_linear<C>::insert(const key_type& k, const mapped_type& d)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash        = h(k);
     auto slot        = slot_type(k, d, hash);
     auto [it, rcode] = insert_intern(slot, hash);
@@ -934,6 +1574,7 @@ template <class C>
 inline typename base_linear<C>::insert_return_type
 base_linear<C>::insert(const value_type& e)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash        = h(e.first);
     auto slot        = slot_type(e, hash);
     auto [it, rcode] = insert_intern(e.first, e.second);
@@ -949,6 +1590,7 @@ template <class... Args>
 inline typename base_linear<C>::insert_return_type
 base_linear<C>::emplace(Args&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto slot        = slot_type(std::forward<Args>(args)...);
     auto hash        = h(slot.get_key_ref());
     auto [it, rcode] = insert_intern(slot, hash);
@@ -963,6 +1605,7 @@ template <class C>
 inline typename base_linear<C>::size_type
 base_linear<C>::erase(const key_type& k)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     ReturnCode c = erase_intern(k);
     return (successful(c)) ? 1 : 0;
 }
@@ -971,6 +1614,7 @@ template <class C>
 inline typename base_linear<C>::size_type
 base_linear<C>::erase_if(const key_type& k, const mapped_type& d)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     ReturnCode c = erase_if_intern(k, d);
     return (successful(c)) ? 1 : 0;
 }
@@ -980,6 +1624,7 @@ template <class F, class... Types>
 inline typename base_linear<C>::insert_return_type
 base_linear<C>::update(const key_type& k, F f, Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto [it, rcode] = update_intern(k, f, std::forward<Types>(args)...);
     return std::make_pair(it, successful(rcode));
 }
@@ -992,6 +1637,7 @@ base_linear<C>::update_with_backoff(const key_type& k,
                                     B               b,
                                     Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto [it, rcode] =
         update_with_backoff_intern(k, f, b, std::forward<Types>(args)...);
     return std::make_pair(it, successful(rcode));
@@ -1003,6 +1649,7 @@ template <class F, class... Types>
 inline typename base_linear<C>::insert_return_type
 base_linear<C>::update_unsafe(const key_type& k, F f, Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto [it, rcode] = update_unsafe_intern(k, f, std::forward<Types>(args)...);
     return std::make_pair(it, successful(rcode));
 }
@@ -1015,6 +1662,7 @@ base_linear<C>::insert_or_update(const key_type&    k,
                                  F                  f,
                                  Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash = h(k);
     auto slot = slot_type(k, d, hash);
     auto [it, rcode] =
@@ -1034,6 +1682,7 @@ base_linear<C>::emplace_or_update(key_type&&    k,
                                   F             f,
                                   Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash = h(k);
     auto slot = slot_type(std::move(k), std::move(d), hash);
     auto [it, rcode] =
@@ -1053,6 +1702,7 @@ base_linear<C>::insert_or_update_unsafe(const key_type&    k,
                                         F                  f,
                                         Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash        = h(k);
     auto slot        = slot_type(k, d, hash);
     auto [it, rcode] = insert_or_update_unsafe_intern(
@@ -1072,6 +1722,7 @@ base_linear<C>::emplace_or_update_unsafe(key_type&&    k,
                                          F             f,
                                          Types&&... args)
 {
+    [[maybe_unused]] reclamation_guard_type guard;
     auto hash        = h(k);
     auto slot        = slot_type(std::move(k), std::move(d), hash);
     auto [it, rcode] = insert_or_update_unsafe_intern(
@@ -1090,6 +1741,108 @@ base_linear<C>::emplace_or_update_unsafe(key_type&&    k,
 
 
 
+// BATCHED FUNCTIONALITY *******************************************************
+
+template <class C>
+template <class F>
+inline typename base_linear<C>::size_type
+base_linear<C>::find_batch(std::span<const key_type> keys, F f)
+{
+    [[maybe_unused]] reclamation_guard_type guard;
+    size_type found = 0;
+    size_type hashes[batch_block_size];
+
+    for (size_type b = 0; b < keys.size(); b += batch_block_size)
+    {
+        size_type n = std::min(batch_block_size, keys.size() - b);
+        h_batch(n, [&](size_type i) { return keys[b + i]; }, hashes);
+        for (size_type i = 0; i < std::min(batch_prefetch_distance, n); ++i)
+            prefetch(hashes[i]);
+
+        for (size_type i = 0; i < n; ++i)
+        {
+            if (i + batch_prefetch_distance < n)
+                prefetch(hashes[i + batch_prefetch_distance]);
+            auto it = find_intern(keys[b + i], hashes[i]);
+            if (it != end()) ++found;
+            f(b + i, it);
+        }
+    }
+    return found;
+}
+
+template <class C>
+inline typename base_linear<C>::size_type
+base_linear<C>::insert_batch(std::span<const batch_element_type> elements)
+{
+    [[maybe_unused]] reclamation_guard_type guard;
+    size_type inserted = 0;
+    size_type hashes[batch_block_size];
+
+    for (size_type b = 0; b < elements.size(); b += batch_block_size)
+    {
+        size_type n = std::min(batch_block_size, elements.size() - b);
+        h_batch(
+            n, [&](size_type i) { return elements[b + i].first; }, hashes);
+        for (size_type i = 0; i < std::min(batch_prefetch_distance, n); ++i)
+            prefetch<true>(hashes[i]);
+
+        for (size_type i = 0; i < n; ++i)
+        {
+            if (i + batch_prefetch_distance < n)
+                prefetch<true>(hashes[i + batch_prefetch_distance]);
+            auto slot =
+                slot_type(elements[b + i].first, elements[b + i].second,
+                          hashes[i]);
+            auto rcode = insert_intern(slot, hashes[i]).second;
+            if (successful(rcode))
+                ++inserted;
+            else if constexpr (slot_config::needs_cleanup)
+                slot.cleanup();
+        }
+    }
+    return inserted;
+}
+
+template <class C>
+template <class F, class... Types>
+inline typename base_linear<C>::size_type
+base_linear<C>::insert_or_update_batch(
+    std::span<const batch_element_type> elements, F f, Types&&... args)
+{
+    [[maybe_unused]] reclamation_guard_type guard;
+    size_type inserted = 0;
+    size_type hashes[batch_block_size];
+
+    for (size_type b = 0; b < elements.size(); b += batch_block_size)
+    {
+        size_type n = std::min(batch_block_size, elements.size() - b);
+        h_batch(
+            n, [&](size_type i) { return elements[b + i].first; }, hashes);
+        for (size_type i = 0; i < std::min(batch_prefetch_distance, n); ++i)
+            prefetch<true>(hashes[i]);
+
+        for (size_type i = 0; i < n; ++i)
+        {
+            if (i + batch_prefetch_distance < n)
+                prefetch<true>(hashes[i + batch_prefetch_distance]);
+            auto slot =
+                slot_type(elements[b + i].first, elements[b + i].second,
+                          hashes[i]);
+            auto rcode =
+                insert_or_update_intern(slot, hashes[i], f, args...).second;
+            if (rcode == ReturnCode::SUCCESS_IN)
+                ++inserted;
+            else if constexpr (slot_config::needs_cleanup)
+                slot.cleanup();
+        }
+    }
+    return inserted;
+}
+
+
+
+
 // MIGRATION/GROWING STUFF *****************************************************
 
 // TRIVIAL MIGRATION (ASSUMES INITIALIZED TABLE)
@@ -1144,9 +1897,42 @@ base_linear<C>::migrate(this_type& target, size_type s, size_type e)
     target.initialize(i, e);
 
     // MIGRATE UNTIL THE END OF THE BLOCK
+    if constexpr (batch_hashable<hash_fct_type, key_type> &&
+                  !slot_config::needs_reclamation &&
+                  !slot_config::stores_hash)
+    {
+        // the keys are hashed in batches before their slots are marked, a
+        // precomputed hash is only used if the key did not change meanwhile
+        key_type  keys[batch_block_size];
+        size_type hashes[batch_block_size];
+        for (; i < long(e); i += batch_block_size)
+        {
+            auto m = std::min(batch_block_size, size_type(e - i));
+            for (size_type j = 0; j < m; ++j)
+            {
+                auto temp = load_slot(i + j);
+                keys[j]   = (temp.is_empty() || temp.is_deleted())
+                                ? key_type()
+                                : temp.get_key();
+            }
+            hash_batch(_hash, keys, m, hashes);
+
+            for (size_type j = 0; j < m; ++j)
+            {
+                curr = load_slot(i + j);
+                while (!_table[i + j].atomic_mark(curr))
+                    curr = load_slot(i + j);
+                if (curr.is_empty() || curr.is_deleted()) continue;
+                auto k = curr.get_key();
+                target.insert_unsafe(curr, (k == keys[j]) ? hashes[j] : h(k));
+                ++n;
+            }
+        }
+        i = e;
+    }
     for (; i < long(e); ++i)
     {
-        curr = _table[i].load();
+        curr = load_slot(i);
         if (!_table[i].atomic_mark(curr))
         {
             --i;
@@ -1176,9 +1962,15 @@ base_linear<C>::migrate(this_type& target, size_type s, size_type e)
         //     target._table[t_pos+j].non_atomic_set(slot_config::get_empty());
         target.initialize(pos);
 
-        curr = _table[pos].load();
+        curr = load_slot(pos);
 
-        if (!_table[pos].atomic_mark(curr)) --i;
+        if (!_table[pos].atomic_mark(curr))
+        {
+            // the slot changed (e.g. concurrent insert) retry without copying,
+            // otherwise the element could be migrated twice
+            --i;
+            continue;
+        }
 
         if ((b = !curr.is_empty())) // this might be nicer as an else if, but
                                     // this is faster
@@ -1226,16 +2018,372 @@ base_linear<C>::migrate(this_type& target, size_type s, size_type e)
     return n;
 }
 
+template <class C>
+inline void base_linear<C>::begin_purge(size_type block_size)
+{
+    auto nblocks =
+        (_mapper.addressable_slots() + block_size - 1) / block_size;
+    _purge_block_size = block_size;
+    _purge_starts     = std::make_unique<std::atomic_size_t[]>(nblocks);
+    for (size_type i = 0; i < nblocks; ++i)
+        _purge_starts[i].store(_purge_unknown, std::memory_order_relaxed);
+    _copy_scheduler.reset();
+
+    // the lookup filter is rebuilt from the remaining elements (otherwise,
+    // erased keys would stay in it forever)
+    if constexpr (config_type::lookup_filter)
+        for (size_type i = 0; i < filter_size(); ++i)
+            _filter[i].store(0, std::memory_order_relaxed);
+}
+
+template <class C>
+inline void base_linear<C>::end_purge()
+{
+    // elements may have moved -> references/iterators have to refresh
+    ++_version;
+    _purge_starts.reset();
+    _copy_scheduler.reset();
+}
+
+// The implicit block of [s,e) begins at its first empty slot. It has to be
+// computed before the previous block rewrites its last cluster (which can
+// temporarily contain new empty slots). Whoever is first publishes it.
+template <class C>
+inline typename base_linear<C>::size_type
+base_linear<C>::purge_start(size_type s, size_type e)
+{
+    auto& start = _purge_starts[s / _purge_block_size];
+    auto  i     = start.load(std::memory_order_acquire);
+    if (i != _purge_unknown) return i;
+
+    for (i = s; i < e; ++i)
+        if (_table[i].load().is_empty()) break;
+
+    auto expected = _purge_unknown;
+    if (!start.compare_exchange_strong(expected, i, std::memory_order_acq_rel))
+        return expected;
+    return i;
+}
+
+// the last cluster of a block ends at j > e, i.e., j is the start of all
+// following blocks that begin before j
+template <class C>
+inline void base_linear<C>::publish_purge_starts(size_type e, size_type j)
+{
+    auto cap = _mapper.addressable_slots();
+    for (size_type p = e; p < j; p += _purge_block_size)
+    {
+        if (!mapper_type::cyclic_probing && p >= cap) return;
+        auto q        = p % cap;
+        auto expected = _purge_unknown;
+        _purge_starts[q / _purge_block_size].compare_exchange_strong(
+            expected, q + (j - p), std::memory_order_acq_rel);
+    }
+}
+
+// Removes deleted dummies from all clusters starting in [s,e] (a cluster
+// starting at e is skipped by the next block, see purge_start). Each element
+// of a cluster is reinserted in order, this moves it at most to its previous
+// position, therefore, all writes stay within the cluster.
+template <class C>
+inline typename base_linear<C>::size_type
+base_linear<C>::purge(size_type s, size_type e)
+{
+    size_type n = 0;
+    size_type i = s;
+
+    if (mapper_type::cyclic_probing || s > 0) i = purge_start(s, e);
+
+    while (i <= e)
+    {
+        if (_table[_mapper.remap(i)].load().is_empty())
+        {
+            ++i;
+            continue;
+        }
+
+        // FIND THE END OF THE CLUSTER
+        size_type j     = i;
+        size_type dummy = 0;
+        for (;; ++j)
+        {
+            auto curr = _table[_mapper.remap(j)].load();
+            if (curr.is_empty()) break;
+            if (curr.is_deleted()) ++dummy;
+        }
+
+        if (j > e) publish_purge_starts(e, j);
+
+        if (dummy)
+        {
+            for (size_type k = i; k < j; ++k)
+            {
+                auto pos  = _mapper.remap(k);
+                auto curr = load_slot(pos);
+                _table[pos].non_atomic_set(slot_config::get_empty());
+                initialize_meta(pos, pos + 1);
+                if (!curr.is_deleted()) insert_unsafe(curr);
+            }
+            n += dummy;
+        }
+        else if constexpr (config_type::lookup_filter)
+        {
+            // the cluster stays, only its filter bits are restored
+            for (size_type k = i; k < j; ++k)
+                filter_add(migration_hash(load_slot(_mapper.remap(k))));
+        }
+        i = j;
+    }
+
+    return n;
+}
+
+// HEALTH SCAN *****************************************************************
+// Each thread counts the tombstones of its blocks and evaluates the clusters
+// that start in its blocks (they can reach into the following blocks). The
+// probe sequence of an element never leaves its cluster, therefore,
+// displacements and fingerprint collisions are computed per cluster.
+template <class C>
+inline table_health
+base_linear<C>::health(size_type num_threads, size_type block_size) const
+{
+    constexpr bool cyclic       = mapper_type::cyclic_probing;
+    constexpr bool fingerprints = requires(const slot_type& s, size_type h) {
+        s.has_fingerprint(h);
+    };
+
+    const size_type slots =
+        (cyclic) ? _mapper.addressable_slots() : _mapper.total_slots();
+    const size_type p       = std::max(num_threads, size_type(1));
+    const size_type bsize   = std::max(block_size, size_type(1));
+    const size_type nblocks = (slots + bsize - 1) / bsize;
+
+    auto next = [this](size_type pos) {
+        return (cyclic) ? (pos + 1) & _mapper.bitmask() : pos + 1;
+    };
+
+    auto cluster = [&](size_type start, table_health& r) {
+        size_type length = 0;
+        for (size_type pos = start; pos < slots && length < slots;
+             pos         = next(pos))
+        {
+            auto curr = load_slot(pos);
+            if (curr.is_empty()) break;
+            ++length;
+            if (curr.is_deleted()) continue;
+
+            auto      hash = h(curr.get_key());
+            size_type home = _mapper.remap(_mapper.map(hash));
+            size_type disp = pos - home;
+            if constexpr (cyclic) disp &= _mapper.bitmask();
+            r.add_element(disp);
+
+            if constexpr (fingerprints)
+            {
+                for (size_type j = home; j != pos; j = next(j))
+                {
+                    auto other = load_slot(j);
+                    ++r.fingerprint_checks;
+                    if (!other.is_deleted() && other.has_fingerprint(hash))
+                        ++r.fingerprint_collisions;
+                }
+            }
+        }
+        r.add_cluster(length);
+    };
+
+    std::vector<table_health> results(p);
+
+    auto scan = [&](size_type t) {
+        [[maybe_unused]] reclamation_guard_type guard;
+
+        auto& r = results[t];
+        for (size_type b = t; b < nblocks; b += p)
+        {
+            size_type s = b * bsize;
+            size_type e = std::min(s + bsize, slots);
+
+            bool prev_empty = true;
+            if (s > 0 || cyclic)
+                prev_empty = load_slot((s > 0) ? s - 1 : slots - 1).is_empty();
+
+            size_type deleted = 0;
+            for (size_type pos = s; pos < e; ++pos)
+            {
+                auto curr = load_slot(pos);
+                if (curr.is_empty())
+                {
+                    prev_empty = true;
+                    continue;
+                }
+                if (curr.is_deleted()) ++deleted;
+                if (prev_empty) cluster(pos, r);
+                prev_empty = false;
+            }
+            r.tombstones += deleted;
+            r.add_block(e - s, deleted);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_type t = 1; t < p; ++t) threads.emplace_back(scan, t);
+    scan(0);
+    for (auto& thread : threads) thread.join();
+
+    table_health result = results[0];
+    for (size_type t = 1; t < p; ++t) result += results[t];
+    result.capacity     = slots;
+    result.block_size   = bsize;
+    result.fingerprints = fingerprints;
+    return result;
+}
+
+template <class C>
+inline base_linear<C>
+base_linear<C>::build_from(std::span<const batch_element_type> elements,
+                           size_type                           num_threads)
+{
+    base_linear table(elements.size());
+    table.bulk_insert_unsafe(elements, num_threads);
+    return table;
+}
+
+// The elements are partitioned by their home slot (i.e. the bits used by
+// mapper_type::map), such that each thread owns a disjoint range of slots
+// and can use plain stores. Elements that would probe past the end of their
+// range are inserted afterwards using the atomic insert.
+template <class C>
+inline typename base_linear<C>::size_type base_linear<C>::bulk_insert_unsafe(
+    std::span<const batch_element_type> elements, size_type num_threads)
+{
+    const size_type p     = std::max(num_threads, size_type(1));
+    const size_type n     = elements.size();
+    const size_type range = (_mapper.addressable_slots() + p - 1) / p;
+    const size_type chunk = (n + p - 1) / p;
+
+    auto parallel = [p](auto f) {
+        std::vector<std::thread> threads;
+        for (size_type t = 1; t < p; ++t) threads.emplace_back(f, t);
+        f(0);
+        for (auto& thread : threads) thread.join();
+    };
+    auto owner = [this, range](size_type hash) {
+        return _mapper.map(hash) / range;
+    };
+
+    // each key is hashed once, the hashes are moved alongside the elements
+    std::vector<size_type> hashes(n);
+    parallel([&](size_type t) {
+        auto e = std::min(n, (t + 1) * chunk);
+        for (size_type b = t * chunk; b < e; b += batch_block_size)
+            h_batch(
+                std::min(batch_block_size, e - b),
+                [&](size_type i) { return elements[b + i].first; },
+                hashes.data() + b);
+    });
+
+    // RADIX PARTITION (HISTOGRAM -> PREFIX SUM -> SCATTER) ********************
+    std::vector<size_type> offsets(p * p, 0); // offsets[t*p + owner]
+    parallel([&](size_type t) {
+        for (size_type i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i)
+            ++offsets[t * p + owner(hashes[i])];
+    });
+
+    std::vector<size_type> bounds(p + 1, 0);
+    for (size_type o = 0, sum = 0; o < p; ++o)
+    {
+        bounds[o] = sum;
+        for (size_type t = 0; t < p; ++t)
+        {
+            auto temp          = offsets[t * p + o];
+            offsets[t * p + o] = sum;
+            sum += temp;
+        }
+    }
+    bounds[p] = n;
+
+    std::vector<batch_element_type> buffer(n);
+    std::vector<size_type>          buffer_hashes(n);
+    parallel([&](size_type t) {
+        for (size_type i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i)
+        {
+            auto j           = offsets[t * p + owner(hashes[i])]++;
+            buffer[j]        = elements[i];
+            buffer_hashes[j] = hashes[i];
+        }
+    });
+
+    // INSERTION INTO OWNED SLOT RANGES ****************************************
+    // (elements that leave their range are inserted afterwards, by index)
+    std::vector<std::vector<size_type>> overflow(p);
+    std::vector<size_type>              inserted(p, 0);
+    parallel([&](size_type t) {
+        // the last range also owns the linear probing buffer
+        size_type end = (t + 1 == p) ? ((mapper_type::cyclic_probing)
+                                            ? _mapper.addressable_slots()
+                                            : _mapper.total_slots())
+                                     : (t + 1) * range;
+        for (size_type j = bounds[t]; j < bounds[t + 1]; ++j)
+        {
+            const auto& e    = buffer[j];
+            auto        hash = buffer_hashes[j];
+            for (size_type i = _mapper.map(hash);; ++i)
+            {
+                if (i >= end)
+                {
+                    overflow[t].push_back(j);
+                    break;
+                }
+                auto curr = load_slot(i);
+                if (curr.is_empty())
+                {
+                    if (!displacement_fits(i - _mapper.map(hash)))
+                    {
+                        overflow[t].push_back(j);
+                        break;
+                    }
+                    raise_bound(_mapper.map(hash), i - _mapper.map(hash));
+                    filter_add(hash);
+                    set_slot(i, slot_type(e.first, e.second, hash));
+                    set_tag(i, hash);
+                    ++inserted[t];
+                    break;
+                }
+                if (curr.compare_key(e.first, hash)) break;
+            }
+        }
+    });
+
+    size_type result = 0;
+    for (size_type t = 0; t < p; ++t)
+    {
+        result += inserted[t];
+        for (auto j : overflow[t])
+        {
+            auto hash  = buffer_hashes[j];
+            auto slot  = slot_type(buffer[j].first, buffer[j].second, hash);
+            auto rcode = insert_intern(slot, hash).second;
+            if (successful(rcode))
+                ++result;
+            else if constexpr (slot_config::needs_cleanup)
+                slot.cleanup();
+        }
+    }
+    return result;
+}
+
 template <class C>
 inline void base_linear<C>::initialize(size_t start, size_t end)
 {
     if constexpr (!_parallel_init) return;
+    if (atomic_fill()) return;
     if constexpr (mapper_type::cyclic_mapping)
     {
         for (size_t i = start, j = end; i <= _mapper.bitmask();
              i += _mapper.grow_helper(), j += _mapper.grow_helper())
         {
             std::fill(_table + i, _table + j, slot_config::get_empty());
+            initialize_meta(i, j);
         }
     }
     else
@@ -1243,6 +2391,8 @@ inline void base_linear<C>::initialize(size_t start, size_t end)
         std::fill(_table + (start << _mapper.grow_helper()),
                   _table + (end << _mapper.grow_helper()),
                   slot_config::get_empty());
+        initialize_meta(start << _mapper.grow_helper(),
+                        end << _mapper.grow_helper());
     }
 }
 
@@ -1250,6 +2400,7 @@ template <class C>
 inline void base_linear<C>::initialize(size_t idx)
 {
     if constexpr (!_parallel_init) return;
+    if (atomic_fill()) return;
     if constexpr (mapper_type::cyclic_mapping)
     {
         if constexpr (!mapper_type::cyclic_probing)
@@ -1259,64 +2410,201 @@ inline void base_linear<C>::initialize(size_t idx)
         for (size_t i = idx; i <= _mapper.bitmask(); i += _mapper.grow_helper())
         {
             _table[i].non_atomic_set(slot_config::get_empty());
+            initialize_meta(i, i + 1);
         }
     }
     else
     {
+        // the linear probing buffer is initialized on construction
+        if ((idx << _mapper.grow_helper()) >= _mapper.addressable_slots())
+            return;
         std::fill(_table + (idx << _mapper.grow_helper()),
                   _table + ((idx + 1) << _mapper.grow_helper()),
                   slot_config::get_empty());
+        initialize_meta(idx << _mapper.grow_helper(),
+                        (idx + 1) << _mapper.grow_helper());
     }
 }
 
 template <class C>
-inline void base_linear<C>::insert_unsafe(const slot_type& e)
+inline void base_linear<C>::initialize_slots(size_type start, size_type end)
 {
-    const key_type k = e.get_key();
+    end = std::min(end, _mapper.total_slots());
+    if (start >= end) return;
+    std::fill(_table + start, _table + end, slot_config::get_empty());
+    initialize_meta(start, end);
+    if constexpr (config_type::lookup_filter)
+    {
+        auto fend = std::min(end, _mapper.addressable_slots());
+        if (start < fend)
+            std::fill(_filter + start / filter_block,
+                      _filter + (fend + filter_block - 1) / filter_block, 0);
+    }
+}
+
+template <class C>
+inline bool
+base_linear<C>::marked_cluster_start(size_type hash, size_type& start) const
+{
+    // slots never become empty again, thus, the cluster can only grow
+    // towards the front until its first slot is marked
+    size_type i = _mapper.map(hash);
+    while (true)
+    {
+        auto curr = _table[_mapper.remap(i)].load();
+        if (curr.is_empty())
+        {
+            start = _mapper.remap(i);
+            return curr.is_marked();
+        }
+        if constexpr (!mapper_type::cyclic_probing)
+        {
+            if (i == 0)
+            {
+                start = 0;
+                return curr.is_marked();
+            }
+        }
+        i = (i == 0) ? _mapper.bitmask() : i - 1;
+    }
+}
 
+template <class C>
+inline void base_linear<C>::insert_unsafe(const slot_type& e)
+{
     // if (e.get_mapped() != 666)
     //     otm::buffered_out() << "unsafe inserting weird element" << std::endl;
 
-    size_type htemp = h(k);
+    insert_unsafe(e, migration_hash(e));
+}
+
+template <class C>
+inline void base_linear<C>::insert_unsafe(const slot_type& e, size_type htemp)
+{
     for (size_type i = _mapper.map(htemp);; ++i)
     {
         size_type temp = _mapper.remap(i);
-        auto      curr = _table[temp].load();
+        auto      curr = load_slot(temp);
 
         if (curr.is_empty())
         {
-            _table[temp].non_atomic_set(e);
+            if (!displacement_fits(i - _mapper.map(htemp)))
+            {
+                auto node = new overflow_node{e, _overflow.load()};
+                while (!_overflow.compare_exchange_weak(node->next, node))
+                { /* retry */
+                }
+                return;
+            }
+            raise_bound(_mapper.map(htemp), i - _mapper.map(htemp));
+            filter_add(htemp);
+            if (!atomic_fill())
+                set_slot(temp, e);
+            else if (!cas_slot(temp, curr, e))
+            {
+                // clusters of different blocks can overlap in smaller tables
+                --i;
+                continue;
+            }
+            set_tag(temp, htemp);
             return;
         }
     }
     throw std::bad_alloc();
 }
 
+template <class C>
+inline bool base_linear<C>::displacement_overflow() const
+{
+    return _overflow.load(std::memory_order_acquire) != nullptr;
+}
+
+template <class C>
+inline typename base_linear<C>::size_type
+base_linear<C>::min_migration_size() const
+{
+    if (!_displacement_full.load(std::memory_order_relaxed)) return 0;
+    return _mapper.addressable_slots() << 1;
+}
+
+// the larger target is initialized on construction (like shrinking targets),
+// since it is filled with atomic insertions
+template <class C>
+inline typename base_linear<C>::mapper_type
+base_linear<C>::overflow_mapper() const
+{
+    return mapper_type(_mapper.addressable_slots() << 1, 0, true);
+}
+
+// called once the migration into this table is finished, concurrent calls
+// (with different targets) only read this table
+template <class C>
+inline void base_linear<C>::migrate_overflowed(this_type& target) const
+{
+    for (size_type i = 0; i < _mapper.total_slots(); ++i)
+    {
+        auto curr = load_slot(i);
+        if (!curr.is_empty() && !curr.is_deleted()) target.insert_unsafe(curr);
+    }
+    for (auto node = _overflow.load(std::memory_order_acquire); node;
+         node = node->next)
+        target.insert_unsafe(node->slot);
+}
+
 
 
 
 
 // base_linear_config stuff
-template <class S, class H, class A, bool CM, bool CP, bool CU>
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::mapper_type(
-    size_t capacity)
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    mapper_type(size_t capacity)
 {
     auto tcapacity = compute_capacity(capacity);
     init_helper(tcapacity);
     _grow_helper = 0;
+    _shrinking   = false;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::mapper_type(
-    size_t capacity, size_t grow_helper)
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    mapper_type(size_t capacity, size_t grow_helper, bool shrinking)
 {
     init_helper(capacity);
     _grow_helper = grow_helper;
+    _shrinking   = shrinking;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
-void base_linear_config<S, H, A, CM, CP, CU>::mapper_type::init_helper(
-    size_t capacity)
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
+void base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    init_helper(size_t capacity)
 {
     if constexpr (cyclic_probing)
         _probe_helper = capacity - 1;
@@ -1330,9 +2618,19 @@ void base_linear_config<S, H, A, CM, CP, CU>::mapper_type::init_helper(
 }
 
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::total_slots() const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    total_slots() const
 {
     if constexpr (cyclic_probing)
         return _probe_helper + 1;
@@ -1340,9 +2638,19 @@ base_linear_config<S, H, A, CM, CP, CU>::mapper_type::total_slots() const
         return _probe_helper;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::addressable_slots() const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    addressable_slots() const
 {
     if constexpr (cyclic_probing)
         return _probe_helper + 1;
@@ -1350,9 +2658,19 @@ base_linear_config<S, H, A, CM, CP, CU>::mapper_type::addressable_slots() const
         return _probe_helper - lp_buffer;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::bitmask() const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    bitmask() const
 {
     if constexpr (cyclic_probing)
         return _probe_helper;
@@ -1362,16 +2680,36 @@ base_linear_config<S, H, A, CM, CP, CU>::mapper_type::bitmask() const
         return _probe_helper - lp_buffer - 1;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::grow_helper() const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    grow_helper() const
 {
     return _grow_helper;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::map(size_t hashed) const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    map(size_t hashed) const
 {
     if constexpr (cyclic_mapping)
         return hashed & _map_helper;
@@ -1379,9 +2717,19 @@ base_linear_config<S, H, A, CM, CP, CU>::mapper_type::map(size_t hashed) const
         return hashed >> _map_helper;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
 inline size_t
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::remap(size_t hashed) const
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::
+    remap(size_t hashed) const
 {
     if constexpr (cyclic_probing)
         return hashed & _probe_helper;
@@ -1389,19 +2737,47 @@ base_linear_config<S, H, A, CM, CP, CU>::mapper_type::remap(size_t hashed) const
         return hashed;
 }
 
-template <class S, class H, class A, bool CM, bool CP, bool CU>
-inline typename base_linear_config<S, H, A, CM, CP, CU>::mapper_type
-base_linear_config<S, H, A, CM, CP, CU>::mapper_type::resize(size_t inserted,
-                                                             size_t deleted)
+template <class S,
+          class H,
+          class A,
+          bool CM,
+          bool CP,
+          bool CU,
+          bool TP,
+          bool BP,
+          bool LF,
+          bool ST>
+inline auto
+base_linear_config<S, H, A, CM, CP, CU, TP, BP, LF, ST>::mapper_type::resize(
+    size_t inserted, size_t deleted, double min_fill_rate, size_t min_size)
+    -> mapper_type
 {
     auto   nsize     = addressable_slots();
-    double fill_rate = double(inserted - deleted) / double(nsize);
+    size_t live      = (inserted > deleted) ? inserted - deleted : 0;
+    double fill_rate = double(live) / double(nsize);
+
+    // with shrinking enabled (min_fill_rate > 0), we halve the size until the
+    // new table would be filled more than shrink_target_fill (this leaves
+    // enough room towards both the growing and the shrinking threshold)
+    if (min_fill_rate > 0. && nsize > min_capacity)
+    {
+        while (nsize > min_capacity && (nsize >> 1) >= min_size &&
+               double(live) / double(nsize >> 1) <= shrink_target_fill)
+            nsize >>= 1;
+        if (nsize < addressable_slots()) return mapper_type(nsize, 0, true);
+    }
 
     if (fill_rate > 0.3) nsize <<= 1;
+    while (nsize < min_size) nsize <<= 1;
 
+    // the target is initialized blockwise during the migration (see
+    // base_linear::initialize), this works for any power of two growth factor
     size_t temp = 0;
     if constexpr (cyclic_mapping) { temp = addressable_slots(); }
-    else { temp = (fill_rate > 0.3) ? 1 : 0; }
+    else
+    {
+        for (auto i = addressable_slots(); i < nsize; i <<= 1) ++temp;
+    }
 
     return mapper_type(nsize, temp);
 }
@@ -13,6 +13,8 @@
 #include <atomic>
 #include <tuple>
 
+#include "data-structures/epoch_reclamation.hpp"
+
 namespace growt
 {
 
@@ -37,6 +39,8 @@ class base_linear_mapped_reference
     using slot_config      = typename base_table_type::slot_config;
     using slot_type        = typename slot_config::slot_type;
     using atomic_slot_type = typename slot_config::atomic_slot_type;
+    using reclamation_guard_type =
+        epoch_guard<slot_config::needs_reclamation>;
 
     template <class, bool> friend class migration_table_mapped_reference;
     template <class, bool> friend class migration_table_reference;
@@ -66,7 +70,20 @@ class base_linear_mapped_reference
     {
     }
 
-    inline void refresh() { _copy = *_ptr; }
+    base_linear_mapped_reference(const base_linear_mapped_reference& rhs)
+        : _copy(rhs._copy), _ptr(rhs._ptr)
+    {
+    }
+
+    base_linear_mapped_reference&
+    operator=(const base_linear_mapped_reference& rhs)
+    {
+        _copy = rhs._copy;
+        _ptr  = rhs._ptr;
+        return *this;
+    }
+
+    inline void refresh() { _copy = _ptr->load(); }
 
     template <bool is_const2 = is_const>
     inline
@@ -77,6 +94,19 @@ class base_linear_mapped_reference
         return *this;
     }
 
+    // false if the slot was marked (the element has to be assigned in the
+    // next table), true once it is overwritten (or deleted)
+    inline bool assign(const mapped_type& value)
+    {
+        while (!_ptr->atomic_update(_copy, _overwrite{}, value).second)
+        {
+            refresh();
+            if (_copy.is_empty() || _copy.is_deleted()) return true;
+            if (_copy.is_marked()) return false;
+        }
+        return true;
+    }
+
     template <class F, class... Args> inline bool update(F f, Args&&... args)
     {
         static_assert(!is_const,
@@ -102,8 +132,12 @@ class base_linear_mapped_reference
     inline operator mapped_type() const { return _copy.get_mapped(); }
 
   private:
-    slot_type         _copy;
-    atomic_slot_type* _ptr;
+    // out-of-line elements (complex_slot) stay alive while the reference
+    // exists, it blocks reclamation and cannot be used by another thread
+    // (see epoch_guard)
+    [[no_unique_address]] reclamation_guard_type _guard;
+    slot_type                                    _copy;
+    atomic_slot_type*                            _ptr;
 };
 
 
@@ -177,6 +211,19 @@ template <class BaseTable, bool is_const = false> class base_linear_iterator
 
     static constexpr bool allows_referential_integrity =
         base_table_type::allows_referential_integrity;
+    using reclamation_guard_type =
+        epoch_guard<slot_config::needs_reclamation>;
+
+    // quotient slots are decoded using their position in the table
+    static constexpr bool needs_position = slot_config::needs_position;
+    struct _no_table
+    {
+        _no_table(const base_table_type*) {}
+    };
+    using table_pointer_type =
+        typename std::conditional<needs_position, const base_table_type*,
+                                  _no_table>::type;
+
     using maybe_const_mapped_reference =
         typename std::conditional<is_const, const mapped_type&,
                                   mapped_type&>::type;
@@ -207,22 +254,26 @@ template <class BaseTable, bool is_const = false> class base_linear_iterator
                            const base_linear_iterator<T, b>& r);
 
     // Constructors ************************************************************
-    base_linear_iterator(const slot_type& copy, atomic_slot_type* ptr,
-                         atomic_slot_type* eptr)
-        : _copy(copy), _ptr(ptr), _eptr(eptr)
+    base_linear_iterator(const slot_type&       copy,
+                         atomic_slot_type*      ptr,
+                         atomic_slot_type*      eptr,
+                         const base_table_type* table = nullptr)
+        : _copy(copy), _ptr(ptr), _eptr(eptr), _table(table)
     {
     }
 
     base_linear_iterator(const base_linear_iterator& rhs)
-        : _copy(rhs._copy), _ptr(rhs._ptr), _eptr(rhs._eptr)
+        : _copy(rhs._copy), _ptr(rhs._ptr), _eptr(rhs._eptr),
+          _table(rhs._table)
     {
     }
 
     base_linear_iterator& operator=(const base_linear_iterator& r)
     {
-        _copy = r._copy;
-        _ptr  = r._ptr;
-        _eptr = r._eptr;
+        _copy  = r._copy;
+        _ptr   = r._ptr;
+        _eptr  = r._eptr;
+        _table = r._table;
         return *this;
     }
 
@@ -234,7 +285,7 @@ template <class BaseTable, bool is_const = false> class base_linear_iterator
         ++_ptr;
         while (_ptr < _eptr)
         {
-            _copy = _ptr->load();
+            _copy = load_copy();
             if (!(_copy.is_empty() || _copy.is_deleted())) return *this;
             ++_ptr;
         }
@@ -274,7 +325,7 @@ template <class BaseTable, bool is_const = false> class base_linear_iterator
     }
 
     // Functions necessary for concurrency *************************************
-    inline void refresh() { _copy = _ptr->load(); }
+    inline void refresh() { _copy = load_copy(); }
 
     inline bool erase()
     {
@@ -292,9 +343,22 @@ template <class BaseTable, bool is_const = false> class base_linear_iterator
     }
 
   private:
-    slot_type         _copy;
-    atomic_slot_type* _ptr;
-    atomic_slot_type* _eptr;
+    // out-of-line elements (complex_slot) stay alive while the iterator
+    // exists, it blocks reclamation and cannot be used by another thread
+    // (see epoch_guard)
+    [[no_unique_address]] reclamation_guard_type _guard;
+    slot_type                                    _copy;
+    atomic_slot_type*                            _ptr;
+    atomic_slot_type*                            _eptr;
+    [[no_unique_address]] table_pointer_type     _table;
+
+    inline slot_type load_copy() const
+    {
+        if constexpr (needs_position)
+            return _table->load_slot(_ptr - _table->_table);
+        else
+            return _ptr->load();
+    }
 };
 
 
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * data-structures/counter_registry.hpp
+ *
+ * Registry of per-handle counters. Every handle allocates its own (padded)
+ * counters at the registry of its table, only the owning thread writes them.
+ * The registry sums the counters of all handles, counters of destroyed
+ * handles are folded into a retired total.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace growt
+{
+
+// only the owning thread writes, readers use relaxed loads
+inline void add_owned(std::atomic_size_t& counter, size_t n = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+}
+
+// Fold{}(total, counters) adds the counters of one handle to a total, the
+// mutex is only used when handles are created or destroyed and for sums,
+// the counters themselves are never locked
+template <class Counters, class Total, class Fold>
+class counter_registry
+{
+  public:
+    counter_registry() : _retired() {}
+    counter_registry(const counter_registry&)            = delete;
+    counter_registry& operator=(const counter_registry&) = delete;
+
+    Counters* add()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _counters.emplace_back(std::make_unique<Counters>());
+        return _counters.back().get();
+    }
+
+    void remove(Counters* counters)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Fold{}(_retired, *counters);
+        auto it = std::find_if(_counters.begin(), _counters.end(),
+                               [counters](const auto& ptr) {
+                                   return ptr.get() == counters;
+                               });
+        std::swap(*it, _counters.back());
+        _counters.pop_back();
+    }
+
+    // adds to the retired total (e.g. updates without handle counters)
+    template <class F> void update_retired(F&& f)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        f(_retired);
+    }
+
+    Total sum() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Total                       result = _retired;
+        for (auto& counters : _counters) Fold{}(result, *counters);
+        return result;
+    }
+
+  private:
+    mutable std::mutex                     _mutex;
+    std::vector<std::unique_ptr<Counters>> _counters;
+    Total                                  _retired;
+};
+
+} // namespace growt
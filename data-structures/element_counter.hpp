@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * data-structures/element_counter.hpp
+ *
+ * Element counts of growing tables. Every handle owns a padded counter with
+ * its total number of insertions and deletions (written only by the owning
+ * thread), size_exact() sums these counters over all handles. Growing
+ * decisions use a combining tree: handles push their new updates in batches
+ * into a leaf of their NUMA node (and cpu group), leaves forward their
+ * accumulated updates in larger batches into the root. The root stores the
+ * occupancy (elements including deleted dummies) of the current table, it
+ * is read by size_approx() and written by few threads at a time.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "data-structures/counter_registry.hpp"
+#include "data-structures/numa_location.hpp"
+
+namespace growt
+{
+
+class element_counter
+{
+  public:
+    // each handle pushes its updates after flush_interval updates
+    static constexpr size_t flush_interval  = 64;
+    static constexpr size_t leaves_per_node = 4;
+    static constexpr size_t num_leaves      = 16;
+
+    // occupancy of the current table (dummies are deleted elements that
+    // still occupy a slot until the next migration)
+    struct occupancy
+    {
+        size_t elements;
+        size_t dummies;
+
+        int64_t live() const { return int64_t(elements) - int64_t(dummies); }
+    };
+
+    class handle_type;
+
+    element_counter() : _root(0) {}
+    element_counter(const element_counter&)            = delete;
+    element_counter& operator=(const element_counter&) = delete;
+
+    handle_type get_handle();
+
+    // sums the counters of all handles, exact if no updates run concurrently
+    size_t size_exact() const
+    {
+        return std::max<int64_t>(_counters.sum(), 0);
+    }
+
+    // misses at most flush_interval updates per handle and one leaf batch
+    // per leaf (see leaf_batch)
+    size_t size_approx() const { return std::max<int64_t>(approx().live(), 0); }
+    occupancy approx() const { return unpack_root(load_root()); }
+
+    // elements inserted without handle counters (bulk insertions)
+    void add_bulk(size_t n)
+    {
+        _counters.update_retired([n](int64_t& retired) { retired += n; });
+        add_root(pack_root(n, 0));
+    }
+
+    // called once a migration has finished, the new table has no dummies
+    // (the live count does not change, updates that are still in the leaves
+    // are forwarded by later pushes, which check for thresholds)
+    void remove_dummies()
+    {
+        auto curr = load_root();
+        while (true)
+        {
+            auto occ  = unpack_root(curr);
+            auto goal = pack_root(
+                occ.elements - std::min(occ.dummies, occ.elements), 0);
+            auto prev = __sync_val_compare_and_swap_16(&_root, curr, goal);
+            if (prev == curr) return;
+            curr = prev;
+        }
+    }
+
+  private:
+    // the total updates of one handle
+    struct alignas(64) handle_counter
+    {
+        std::atomic_size_t inserted{0};
+        std::atomic_size_t deleted{0};
+    };
+
+    struct fold_counter
+    {
+        void operator()(int64_t& total, const handle_counter& counter) const
+        {
+            total += int64_t(counter.inserted.load(std::memory_order_relaxed)) -
+                     int64_t(counter.deleted.load(std::memory_order_relaxed));
+        }
+    };
+
+    struct alignas(64) leaf_type
+    {
+        std::atomic_uint64_t value{0};
+    };
+
+    using root_word = unsigned __int128;
+
+    // leaves pack elements and dummies into one word, such that each push
+    // is a single fetch_add (a leaf holds at most one batch plus the pending
+    // updates of its handles, 32 bits per half suffice)
+    static constexpr uint64_t pack(size_t elements, size_t dummies)
+    {
+        return (uint64_t(dummies) << 32) + uint64_t(elements);
+    }
+    static constexpr occupancy unpack(uint64_t value)
+    {
+        return occupancy{size_t(value & 0xffffffffull), size_t(value >> 32)};
+    }
+
+    // the root counts all elements of the table, it uses 64 bits per half
+    // and is updated with a 16 byte cas (both halves only grow between
+    // migrations, so a packed leaf value can be added to both at once)
+    static constexpr root_word pack_root(size_t elements, size_t dummies)
+    {
+        return (root_word(dummies) << 64) + root_word(elements);
+    }
+    static constexpr root_word widen(uint64_t leaf_value)
+    {
+        auto occ = unpack(leaf_value);
+        return pack_root(occ.elements, occ.dummies);
+    }
+    static constexpr occupancy unpack_root(root_word value)
+    {
+        return occupancy{size_t(uint64_t(value)), size_t(value >> 64)};
+    }
+
+    // there is no plain atomic 16 byte load, a cas with equal expected and
+    // new value reads both halves consistently (loading the halves separately
+    // could combine them from different writes, remove_dummies lowers the
+    // elements again)
+    root_word load_root() const
+    {
+        return __sync_val_compare_and_swap_16(&_root, 0, 0);
+    }
+    // returns the value before the addition
+    root_word add_root(root_word delta)
+    {
+        auto curr = load_root();
+        while (true)
+        {
+            auto prev = __sync_val_compare_and_swap_16(&_root, curr,
+                                                       curr + delta);
+            if (prev == curr) return prev;
+            curr = prev;
+        }
+    }
+
+    // leaves forward their updates in batches that grow with the table, the
+    // root then lags behind by at most num_leaves/1024 of the capacity
+    static size_t leaf_batch(size_t capacity)
+    {
+        return std::max(flush_interval, capacity >> 10);
+    }
+
+    // the leaf is chosen by the node and cpu of the thread creating the
+    // handle (handles are used by one thread)
+    static size_t local_leaf()
+    {
+        auto loc = this_cpu_location();
+        return (loc.node * leaves_per_node + loc.cpu % leaves_per_node) %
+               num_leaves;
+    }
+
+    alignas(64) mutable root_word _root;
+    leaf_type _leaves[num_leaves];
+
+    counter_registry<handle_counter, int64_t, fold_counter> _counters;
+};
+
+
+
+// HANDLE LOCAL PART ***********************************************************
+class element_counter::handle_type
+{
+  public:
+    handle_type(element_counter& global)
+        : _global(&global), _counter(global._counters.add()),
+          _leaf(&global._leaves[local_leaf()]), _inserted(0), _deleted(0)
+    {
+    }
+
+    handle_type(const handle_type&)            = delete;
+    handle_type& operator=(const handle_type&) = delete;
+
+    handle_type(handle_type&& rhs) noexcept
+        : _global(rhs._global), _counter(rhs._counter), _leaf(rhs._leaf),
+          _inserted(rhs._inserted), _deleted(rhs._deleted)
+    {
+        rhs._counter  = nullptr;
+        rhs._inserted = 0;
+        rhs._deleted  = 0;
+    }
+    handle_type& operator=(handle_type&&) = delete;
+
+    ~handle_type()
+    {
+        if (_counter) _global->_counters.remove(_counter);
+    }
+
+    // return true, once the pending updates should be pushed
+    bool inc_inserted()
+    {
+        add_owned(_counter->inserted);
+        return ++_inserted + _deleted >= flush_interval;
+    }
+    bool inc_deleted()
+    {
+        add_owned(_counter->deleted);
+        return _inserted + ++_deleted >= flush_interval;
+    }
+
+    size_t pending() const { return _inserted + _deleted; }
+
+    // pushes the pending updates into the leaf, if this forwards the leaf
+    // into the root, the occupancy before and after the change is returned
+    // (forward_leaf forces this, e.g. when the handle is destroyed)
+    std::optional<std::pair<occupancy, occupancy>>
+    push(size_t capacity, bool forward_leaf = false)
+    {
+        if (!_counter || (!forward_leaf && !pending())) return std::nullopt;
+        auto delta = pack(_inserted, _deleted);
+        _inserted  = 0;
+        _deleted   = 0;
+
+        auto leaf = unpack(
+            _leaf->value.fetch_add(delta, std::memory_order_acq_rel) + delta);
+        if (!forward_leaf &&
+            leaf.elements + leaf.dummies < leaf_batch(capacity))
+            return std::nullopt;
+
+        // forward everything that accumulated in the leaf (possibly 0, if
+        // another handle was faster)
+        auto forward = _leaf->value.exchange(0, std::memory_order_acq_rel);
+        if (!forward) return std::nullopt;
+        auto delta_root = widen(forward);
+        auto prev       = _global->add_root(delta_root);
+        return std::make_pair(unpack_root(prev),
+                              unpack_root(prev + delta_root));
+    }
+
+  private:
+    element_counter* _global;
+    handle_counter*  _counter;
+    leaf_type*       _leaf;
+    size_t           _inserted; // not yet pushed
+    size_t           _deleted;
+};
+
+inline element_counter::handle_type element_counter::get_handle()
+{
+    return handle_type(*this);
+}
+
+} // namespace growt
@@ -1,19 +1,28 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 
 #include "utils/debug.hpp"
 namespace debug = utils_tm::debug_tm;
 
+#include "allocator/slaballocator.hpp"
+#include "data-structures/epoch_reclamation.hpp"
 #include "data-structures/returnelement.hpp"
 
 namespace growt
 {
 
-#ifdef TBB_AS_DEFAULT
+#if defined(SLAB_AS_DEFAULT)
+// single value_type allocations are served from thread local slabs, freed
+// elements (e.g. cleanup after a failed insert) go to a per thread free list
+using default_allocator = SlabAllocator<>;
+#elif defined(TBB_AS_DEFAULT)
 #include "tbb/scalable_allocator.h"
 using default_allocator = tbb::scalable_allocator<void>;
 #else
@@ -45,10 +54,24 @@ struct ptr_splitter<false>
     void set_unmark() {}
 };
 
+// Updates are copy-on-write by default: a new pair is allocated, the pointer
+// word is swapped with one CAS, and the old pair is retired. Alternatively
+// (inplace_updates) the out-of-line mapped value is changed in place, either
+// using f.atomic(...) or a CAS on the mapped value (small trivial types).
+// Mapped types that cannot be copied are always updated in place.
+//
+// With stored_hash, the fingerprint bits hold the displacement from the home
+// slot (6 bits) and the hash bits directly below the home slot bits (marked by
+// a leading one). Slots are then encoded/decoded with their position (like
+// quotient_slot) and a loaded slot knows the top bits of its hash. Migrations
+// use them to place elements without rehashing (each doubling uses one of the
+// stored bits, the key is only rehashed once they are used up).
 template <class Key,
           class Data,
           bool markable,
-          class Allocator = default_allocator>
+          class Allocator      = default_allocator,
+          bool inplace_updates = false,
+          bool stored_hash     = false>
 class complex_slot
 {
     using ptr_split = ptr_splitter<markable>;
@@ -62,13 +85,34 @@ class complex_slot
     static_assert(std::atomic<ptr_union>::is_always_lock_free,
                   "complex slot atomic is not lock free");
 
-    static constexpr size_t fingerprint_mask =
-        (markable) ? (1ull << 15) - 1 : (1ull << 16) - 1;
+    static constexpr size_t fingerprint_bits = (markable) ? 15 : 16;
+    static constexpr size_t fingerprint_mask = (1ull << fingerprint_bits) - 1;
     inline static constexpr size_t fingerprint(size_t hash)
     {
         return hash & fingerprint_mask;
     }
 
+    // fingerprint layout with stored_hash: [1 hash bits...] [displacement]
+    static constexpr size_t displacement_bits = 6;
+    static constexpr size_t unknown_displacement =
+        (1ull << displacement_bits) - 1;
+    static constexpr size_t window_bits = fingerprint_bits - displacement_bits;
+
+    // hash bits that are known for a loaded slot (top bits, see mask)
+    struct known_hash
+    {
+        size_t hash = 0;
+        size_t mask = 0;
+    };
+    struct no_known_hash
+    {
+    };
+    using known_hash_type =
+        std::conditional_t<stored_hash, known_hash, no_known_hash>;
+
+    static constexpr bool copy_on_write =
+        !inplace_updates && std::is_copy_constructible_v<Data>;
+
   public:
     using key_type       = Key;
     using mapped_type    = Data;
@@ -77,11 +121,20 @@ class complex_slot
         Allocator>::template rebind_alloc<value_type>;
 
     static constexpr bool allows_marking               = markable;
-    static constexpr bool allows_deletions             = false;
-    static constexpr bool allows_atomic_updates        = false;
-    static constexpr bool allows_updates               = false;
+    static constexpr bool allows_deletions             = true;
+    static constexpr bool allows_atomic_updates        = true;
+    static constexpr bool allows_updates               = true;
     static constexpr bool allows_referential_integrity = true;
     static constexpr bool needs_cleanup                = true;
+    // erased elements are retired (see epoch_reclamation.hpp), therefore,
+    // table operations have to be executed within an epoch_guard
+    static constexpr bool needs_reclamation            = true;
+    static constexpr bool needs_position               = stored_hash;
+    static constexpr bool stores_hash                  = stored_hash;
+    // positioned tables need these, any displacement can be stored (large
+    // displacements are stored as unknown, the slot then knows no hash bits)
+    static constexpr size_t min_capacity     = 0;
+    static constexpr size_t max_displacement = ~size_t(0);
 
     class atomic_slot_type;
 
@@ -89,7 +142,8 @@ class complex_slot
     class slot_type
     {
       private:
-        ptr_union _mfptr;
+        ptr_union                             _mfptr;
+        [[no_unique_address]] known_hash_type _hinfo;
 
         friend atomic_slot_type;
 
@@ -115,9 +169,15 @@ class complex_slot
         inline value_type*       get_pointer();
         inline void              set_fingerprint(size_t hash);
 
+        // known (top) hash bits of a positioned load (only with stored_hash)
+        inline size_t get_hash() const { return _hinfo.hash; }
+        inline size_t hash_bits() const { return std::popcount(_hinfo.mask); }
+
         inline bool is_empty() const;
         inline bool is_deleted() const;
         inline bool is_marked() const;
+        // only compares the stored fingerprint (see table_health.hpp)
+        inline bool has_fingerprint(size_t hash) const;
         inline bool compare_key(const key_type& k, size_t hash) const;
         // inline void cleanup()    const;
 
@@ -135,6 +195,14 @@ class complex_slot
       private:
         std::atomic<uint64_t> _aptr;
 
+        template <class Mapper>
+        static uint64_t encode(const slot_type& goal,
+                               size_t           pos,
+                               const Mapper&    mapper);
+        template <class Mapper>
+        static slot_type
+        decode(uint64_t word, size_t pos, const Mapper& mapper);
+
       public:
         atomic_slot_type(const atomic_slot_type& source);
         atomic_slot_type& operator=(const atomic_slot_type& source);
@@ -153,6 +221,25 @@ class complex_slot
         atomic_update(slot_type& expected, F f, Types&&... args);
         template <class F, class... Types>
         std::pair<slot_type, bool> non_atomic_update(F f, Types&&... args);
+
+        // positioned accesses (only with stored_hash, pos is the index of
+        // this slot)
+        template <class Mapper>
+        slot_type load(size_t pos, const Mapper& mapper) const;
+        template <class Mapper>
+        void non_atomic_set(const slot_type& goal,
+                            size_t           pos,
+                            const Mapper&    mapper);
+        template <class Mapper>
+        bool cas(slot_type&       expected,
+                 const slot_type& goal,
+                 size_t           pos,
+                 const Mapper&    mapper);
+        template <class Mapper, class F, class... Types>
+        std::pair<slot_type, bool> non_atomic_update_at(size_t        pos,
+                                                        const Mapper& mapper,
+                                                        F             f,
+                                                        Types&&... args);
     };
 
     // static constexpr slot_type empty{ptr_union{uint64_t(0)}};
@@ -179,62 +266,75 @@ class complex_slot
         // free(ptr);
         std::allocator_traits<allocator_type>::deallocate(allocator, ptr, 1);
     }
+    // called by the epoch_manager once no thread can access the element
+    static void reclaim(void* ptr)
+    {
+        auto vptr = static_cast<value_type*>(ptr);
+        vptr->first.~key_type();
+        vptr->second.~mapped_type();
+        deallocate(vptr);
+    }
 
-    static std::string name() { return "complex_slot"; }
+    static std::string name()
+    {
+        std::string name =
+            (inplace_updates) ? "complex_slot_inplace" : "complex_slot";
+        return (stored_hash) ? name + "_hash" : name;
+    }
 
   private:
-    static allocator_type allocator;
+    static inline allocator_type allocator;
 };
 
 
 
 // SLOT_TYPE *******************************************************************
 // *** statics *****************************************************************
-// template <class K, class D, bool m, class A>
+// template <class K, class D, bool m, class A, bool iu, bool sh>
 // static complex_slot<K,D,m,A>::empty = complex_slot<K,D,m,A>::slot_type(
 //     typename complex_slot<K,D,m,A>::ptr_union{ptr_union(0)});
 
 // *** constructors ************************************************************
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::slot_type(const key_type&    k,
-                                               const mapped_type& d,
-                                               size_t             hash)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(const key_type&    k,
+                                                       const mapped_type& d,
+                                                       size_t             hash)
     : _mfptr(ptr_union{0})
 {
     auto ptr = allocate();
     new (ptr) std::pair<const key_type, mapped_type>{k, d};
-    _mfptr.split.pointer     = uint64_t(ptr);
-    _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
+    _mfptr.split.pointer = uint64_t(ptr);
+    set_fingerprint(hash);
 }
 
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::slot_type(const value_type& pair,
-                                               size_t            hash)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(const value_type& pair,
+                                                       size_t            hash)
     : _mfptr(ptr_union{0})
 {
     auto ptr = allocate();
     new (ptr) std::pair<const key_type, mapped_type>{pair};
-    _mfptr.split.pointer     = uint64_t(ptr);
-    _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
+    _mfptr.split.pointer = uint64_t(ptr);
+    set_fingerprint(hash);
 }
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::slot_type(key_type&&    k,
-                                               mapped_type&& d,
-                                               size_t        hash)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(key_type&&    k,
+                                                       mapped_type&& d,
+                                                       size_t        hash)
     : _mfptr(ptr_union{0})
 {
     auto ptr = allocate();
     new (ptr)
         std::pair<const key_type, mapped_type>{std::move(k), std::move(d)};
-    _mfptr.split.pointer     = uint64_t(ptr);
-    _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
+    _mfptr.split.pointer = uint64_t(ptr);
+    set_fingerprint(hash);
 }
 
-template <class K, class D, bool m, class A>
+template <class K, class D, bool m, class A, bool iu, bool sh>
 template <class... Args>
-complex_slot<K, D, m, A>::slot_type::slot_type(Args&&... args)
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(Args&&... args)
     : _mfptr(ptr_union{0})
 {
     // static_assert(Args);
@@ -248,26 +348,27 @@ complex_slot<K, D, m, A>::slot_type::slot_type(Args&&... args)
     //_mfptr.split.fingerprint = complex_slot::fingerprint(hash);
 }
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::slot_type(value_type&& pair, size_t hash)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(value_type&& pair,
+                                                       size_t       hash)
     : _mfptr(ptr_union{0})
 {
     auto ptr = allocate();
     new (ptr) std::pair<const key_type, mapped_type>{std::move(pair)};
-    _mfptr.split.pointer     = uint64_t(ptr);
-    _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
+    _mfptr.split.pointer = uint64_t(ptr);
+    set_fingerprint(hash);
 }
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::slot_type(ptr_union source)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::slot_type(ptr_union source)
     : _mfptr(source)
 {
 }
 
 // *** getter ******************************************************************
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::key_type
-complex_slot<K, D, m, A>::slot_type::get_key() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::key_type
+complex_slot<K, D, m, A, iu, sh>::slot_type::get_key() const
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (!ptr)
@@ -278,18 +379,18 @@ complex_slot<K, D, m, A>::slot_type::get_key() const
     return ptr->first;
 }
 
-template <class K, class D, bool m, class A>
-const typename complex_slot<K, D, m, A>::key_type&
-complex_slot<K, D, m, A>::slot_type::get_key_ref() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+const typename complex_slot<K, D, m, A, iu, sh>::key_type&
+complex_slot<K, D, m, A, iu, sh>::slot_type::get_key_ref() const
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (!ptr) { debug::if_debug("getting key from empty slot"); }
     return ptr->first;
 }
 
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::mapped_type
-complex_slot<K, D, m, A>::slot_type::get_mapped() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::mapped_type
+complex_slot<K, D, m, A, iu, sh>::slot_type::get_mapped() const
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (!ptr)
@@ -300,58 +401,74 @@ complex_slot<K, D, m, A>::slot_type::get_mapped() const
     return ptr->second;
 }
 
-template <class K, class D, bool m, class A>
-const typename complex_slot<K, D, m, A>::value_type*
-complex_slot<K, D, m, A>::slot_type::get_pointer() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+const typename complex_slot<K, D, m, A, iu, sh>::value_type*
+complex_slot<K, D, m, A, iu, sh>::slot_type::get_pointer() const
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (!ptr) { debug::if_debug("getting pointer from an empty slot"); }
     return ptr;
 }
 
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::value_type*
-complex_slot<K, D, m, A>::slot_type::get_pointer()
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::value_type*
+complex_slot<K, D, m, A, iu, sh>::slot_type::get_pointer()
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (!ptr) { debug::if_debug("getting key from empty slot"); }
     return ptr;
 }
 
-template <class K, class D, bool m, class A>
-void complex_slot<K, D, m, A>::slot_type::set_fingerprint(size_t hash)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+void complex_slot<K, D, m, A, iu, sh>::slot_type::set_fingerprint(size_t hash)
 {
-    _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
+    // with stored_hash, the fingerprint is written by the positioned accesses
+    if constexpr (sh)
+        _hinfo = known_hash{hash, ~size_t(0)};
+    else
+        _mfptr.split.fingerprint = complex_slot::fingerprint(hash);
 }
 
 // *** state *******************************************************************
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::is_empty() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::is_empty() const
 {
     if constexpr (!m) return _mfptr.full == 0;
     return _mfptr.split.pointer == 0;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::is_deleted() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::is_deleted() const
 {
-    return _mfptr.full == complex_slot::get_deleted()._mfptr.full;
+    // ignores mark and fingerprint (deleted slots can be marked for migration)
+    return _mfptr.split.pointer ==
+           complex_slot::get_deleted()._mfptr.split.pointer;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::is_marked() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::is_marked() const
 {
     if constexpr (!m) return false;
     return _mfptr.split.mark;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::compare_key(const key_type& k,
-                                                      size_t hash) const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::has_fingerprint(
+    size_t hash) const
+{
+    if constexpr (sh)
+        return !((hash ^ _hinfo.hash) & _hinfo.mask);
+    else
+        return fingerprint(hash) == _mfptr.split.fingerprint;
+}
+
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::compare_key(
+    const key_type& k, size_t hash) const
 {
-    if (fingerprint(hash) != _mfptr.split.fingerprint) return false;
+    if (!has_fingerprint(hash)) return false;
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
-    if (ptr == nullptr)
+    if (ptr == nullptr || is_deleted())
     {
         // debug::if_debug("comparison with an empty slot");
         return false;
@@ -360,8 +477,8 @@ bool complex_slot<K, D, m, A>::slot_type::compare_key(const key_type& k,
 }
 
 // *** operators ***************************************************************
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::slot_type::operator value_type() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::slot_type::operator value_type() const
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
     if (ptr == nullptr)
@@ -371,8 +488,9 @@ complex_slot<K, D, m, A>::slot_type::operator value_type() const
     return *ptr;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::operator==(const slot_type& r) const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::operator==(
+    const slot_type& r) const
 {
     if (_mfptr.fingerprint != r._mfptr.fingerprint) return false;
     auto ptr0 = reinterpret_cast<value_type*>(_mfptr.split.pointer);
@@ -390,8 +508,9 @@ bool complex_slot<K, D, m, A>::slot_type::operator==(const slot_type& r) const
     return ptr0->key == ptr1->key;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::slot_type::operator!=(const slot_type& r) const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::slot_type::operator!=(
+    const slot_type& r) const
 {
     if (_mfptr.fingerprint != r._mfptr.fingerprint) return false;
     auto ptr0 = reinterpret_cast<value_type*>(_mfptr.split.pointer);
@@ -411,11 +530,11 @@ bool complex_slot<K, D, m, A>::slot_type::operator!=(const slot_type& r) const
 
 
 // *** cleanup *****************************************************************
-template <class K, class D, bool m, class A>
-void complex_slot<K, D, m, A>::slot_type::cleanup()
+template <class K, class D, bool m, class A, bool iu, bool sh>
+void complex_slot<K, D, m, A, iu, sh>::slot_type::cleanup()
 {
     auto ptr = reinterpret_cast<value_type*>(_mfptr.split.pointer);
-    if (!ptr)
+    if (!ptr || is_deleted())
     {
         // debug::if_debug("cleanup on empty slot");
         return;
@@ -430,73 +549,136 @@ void complex_slot<K, D, m, A>::slot_type::cleanup()
 // ATOMIC_SLOT_TYPE ************************************************************
 // *** constructors
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::atomic_slot_type::atomic_slot_type(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::atomic_slot_type(
     const atomic_slot_type& source)
     : _aptr(source.load()._mfptr.full)
 {
 }
 
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::atomic_slot_type&
-complex_slot<K, D, m, A>::atomic_slot_type::operator=(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::atomic_slot_type&
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::operator=(
     const atomic_slot_type& source)
 {
     non_atomic_set(source.load());
     return *this;
 }
 
-template <class K, class D, bool m, class A>
-complex_slot<K, D, m, A>::atomic_slot_type::atomic_slot_type(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::atomic_slot_type(
     const slot_type& source)
     : _aptr(source._mfptr.full)
 {
 }
 
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::atomic_slot_type&
-complex_slot<K, D, m, A>::atomic_slot_type::operator=(const slot_type& source)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::atomic_slot_type&
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::operator=(
+    const slot_type& source)
 {
     non_atomic_set(source);
     return *this;
 }
 
+// *** encoding (stored_hash) **************************************************
+// the known hash bits below the home slot bits are stored (at most
+// window_bits-1 of them), if the home slot is not known, nothing is stored.
+// Unpositioned writes (e.g. mapped references) leave an empty window, it is
+// decoded like an unknown displacement.
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper>
+uint64_t complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::encode(
+    const slot_type& goal, size_t pos, const Mapper& mapper)
+{
+    ptr_union result    = goal._mfptr;
+    auto      shift     = mapper.right_shift();
+    auto      home_mask = ~size_t(0) << shift;
+    size_t    disp      = unknown_displacement;
+    size_t    window    = 0;
+
+    if ((goal._hinfo.mask & home_mask) == home_mask)
+    {
+        auto home  = mapper.map(goal._hinfo.hash);
+        disp       = std::min<size_t>(mapper.remap(pos - home),
+                                          unknown_displacement);
+        auto below = size_t(std::popcount(goal._hinfo.mask)) - (64 - shift);
+        auto nbits = std::min(below, window_bits - 1);
+        window     = size_t(1) << nbits;
+        if (nbits)
+            window |= (goal._hinfo.hash << (64 - shift)) >> (64 - nbits);
+    }
+    if (disp == unknown_displacement) window = 0;
+
+    result.split.fingerprint = (window << displacement_bits) | disp;
+    return result.full;
+}
+
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper>
+typename complex_slot<K, D, m, A, iu, sh>::slot_type
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::decode(
+    uint64_t word, size_t pos, const Mapper& mapper)
+{
+    ptr_union pu;
+    pu.full   = word;
+    auto temp = slot_type(pu);
+    if (temp.is_empty() || temp.is_deleted()) return temp;
+
+    size_t disp   = pu.split.fingerprint & unknown_displacement;
+    size_t window = pu.split.fingerprint >> displacement_bits;
+    if (disp == unknown_displacement || window == 0) return temp;
+
+    auto shift = mapper.right_shift();
+    auto nbits = size_t(std::bit_width(window)) - 1;
+    auto home  = mapper.remap(pos - disp);
+    temp._hinfo.hash = (home << shift) |
+                       ((window ^ (size_t(1) << nbits)) << (shift - nbits));
+    temp._hinfo.mask = ~size_t(0) << (shift - nbits);
+    return temp;
+}
+
 // *** common atomics **********************************************************
-template <class K, class D, bool m, class A>
-typename complex_slot<K, D, m, A>::slot_type
-complex_slot<K, D, m, A>::atomic_slot_type::load() const
+template <class K, class D, bool m, class A, bool iu, bool sh>
+typename complex_slot<K, D, m, A, iu, sh>::slot_type
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::load() const
 {
     ptr_union pu;
     pu.full = _aptr.load(std::memory_order_relaxed);
     return pu;
 }
 
-template <class K, class D, bool m, class A>
-void complex_slot<K, D, m, A>::atomic_slot_type::non_atomic_set(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+void complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::non_atomic_set(
     const slot_type& source)
 {
     reinterpret_cast<size_t&>(_aptr) = source._mfptr.full;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::atomic_slot_type::cas(slot_type&       expected,
-                                                     const slot_type& goal)
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::cas(
+    slot_type& expected, const slot_type& goal)
 {
     return _aptr.compare_exchange_strong(expected._mfptr.full, goal._mfptr.full,
                                          std::memory_order_relaxed);
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::atomic_slot_type::atomic_delete(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::atomic_delete(
     slot_type& expected)
 {
-    return _aptr.compare_exchange_strong(expected._mfptr.full,
-                                         get_deleted._mfptr.full,
-                                         std::memory_order_relaxed);
+    if (!_aptr.compare_exchange_strong(expected._mfptr.full,
+                                       get_deleted()._mfptr.full,
+                                       std::memory_order_relaxed))
+        return false;
+
+    // the pair can still be read by concurrent operations
+    epoch_manager::retire(expected.get_pointer(), &complex_slot::reclaim);
+    return true;
 }
 
-template <class K, class D, bool m, class A>
-bool complex_slot<K, D, m, A>::atomic_slot_type::atomic_mark(
+template <class K, class D, bool m, class A, bool iu, bool sh>
+bool complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::atomic_mark(
     slot_type& expected)
 {
     if constexpr (!m) return true;
@@ -544,8 +726,6 @@ class _atomic_helper_type
             F                                                     f,
             Types... args)
     {
-        // UGLY (Same as non_atomic_update)
-        // typename SlotType::slot_type slot = that->load();
         auto key_value = curr.get_pointer();
         f.atomic(key_value->second, std::forward<Types>(args)...);
         using slot_type = typename SlotType::slot_type;
@@ -566,24 +746,18 @@ class _atomic_helper_type<SlotType, false>
             Types... args)
     {
         using mapped_type = typename SlotType::mapped_type;
-        static_assert(sizeof(mapped_type) == sizeof(std::atomic<mapped_type>),
-                      "Error in complex_slot::atomic_update the mapped_type "
-                      "cannot act as atomic member");
         static_assert(
-            std::atomic<mapped_type>::is_always_lock_free,
+            std::atomic_ref<mapped_type>::is_always_lock_free,
             "Error in complex_slot::atomic_update the mapped type "
             "does not support atomics thus the provided function "
             "must itself be atomic, if it is it should be named *.atomic");
-        using atomic_mapped_type = std::atomic<mapped_type>;
-        using slot_type          = typename SlotType::slot_type;
-        // auto slot      = that->load();
+        using slot_type = typename SlotType::slot_type;
         auto key_value_ptr = expected.get_pointer();
-        auto atomapped =
-            reinterpret_cast<atomic_mapped_type*>(&(key_value_ptr->second));
-        auto expmapped = atomapped.load();
+        auto atomapped = std::atomic_ref<mapped_type>(key_value_ptr->second);
+        auto expmapped = atomapped.load(std::memory_order_relaxed);
         auto newmapped = expmapped;
         f(newmapped, std::forward<Types>(args)...);
-        bool succ = atomapped->compare_exchange_strong(
+        bool succ = atomapped.compare_exchange_strong(
             expmapped, newmapped, std::memory_order_relaxed);
         return std::make_pair(static_cast<const slot_type&>(expected), succ);
     }
@@ -592,28 +766,95 @@ class _atomic_helper_type<SlotType, false>
 
 
 // *** functor style updates ***************************************************
-template <class K, class D, bool m, class A>
+template <class K, class D, bool m, class A, bool iu, bool sh>
 template <class F, class... Types>
-std::pair<typename complex_slot<K, D, m, A>::slot_type, bool>
-complex_slot<K, D, m, A>::atomic_slot_type::atomic_update(slot_type& expected,
-                                                          F          f,
-                                                          Types&&... args)
+std::pair<typename complex_slot<K, D, m, A, iu, sh>::slot_type, bool>
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::atomic_update(
+    slot_type& expected, F f, Types&&... args)
 {
-    return _complex_atomic_helper::_atomic_helper_type<
-        complex_slot, _complex_atomic_helper::_has_atomic_type<F>::value>::
-        execute(this, expected, f, std::forward<Types>(args)...);
+    if constexpr (!copy_on_write)
+    {
+        return _complex_atomic_helper::_atomic_helper_type<
+            complex_slot, _complex_atomic_helper::_has_atomic_type<F>::value>::
+            execute(this, expected, f, std::forward<Types>(args)...);
+    }
+    else
+    {
+        // copy-on-write (the marking bit is part of expected, therefore, the
+        // cas fails on marked slots)
+        auto optr = expected.get_pointer();
+        auto nptr = allocate();
+        new (nptr) value_type{optr->first, optr->second};
+        f(nptr->second, std::forward<Types>(args)...);
+
+        ptr_union goal     = expected._mfptr;
+        goal.split.pointer = uint64_t(nptr);
+        if (!_aptr.compare_exchange_strong(expected._mfptr.full, goal.full,
+                                           std::memory_order_relaxed))
+        {
+            // the new pair was never visible
+            reclaim(nptr);
+            return std::make_pair(expected, false);
+        }
+
+        epoch_manager::retire(optr, &complex_slot::reclaim);
+        return std::make_pair(slot_type(goal), true);
+    }
 }
 
-template <class K, class D, bool m, class A>
+template <class K, class D, bool m, class A, bool iu, bool sh>
 template <class F, class... Types>
-std::pair<typename complex_slot<K, D, m, A>::slot_type, bool>
-complex_slot<K, D, m, A>::atomic_slot_type::non_atomic_update(F f,
-                                                              Types&&... args)
+std::pair<typename complex_slot<K, D, m, A, iu, sh>::slot_type, bool>
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::non_atomic_update(
+    F f, Types&&... args)
 {
+    // NON-ATOMIC-UPDATES ARE INHERENTLY UNSAFE (no copy, even without iu)
     slot_type slot      = load();
     auto      key_value = slot.get_pointer();
-    f.atomic(key_value->second, std::forward<Types>(args)...);
+    f(key_value->second, std::forward<Types>(args)...);
     return std::make_pair(std::move(slot), true);
 }
 
+// *** positioned accesses (stored_hash) ***************************************
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper>
+typename complex_slot<K, D, m, A, iu, sh>::slot_type
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::load(
+    size_t pos, const Mapper& mapper) const
+{
+    return decode(_aptr.load(std::memory_order_relaxed), pos, mapper);
+}
+
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper>
+void complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::non_atomic_set(
+    const slot_type& goal, size_t pos, const Mapper& mapper)
+{
+    reinterpret_cast<size_t&>(_aptr) = encode(goal, pos, mapper);
+}
+
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper>
+bool complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::cas(
+    slot_type& expected, const slot_type& goal, size_t pos,
+    const Mapper& mapper)
+{
+    auto word = expected._mfptr.full;
+    if (_aptr.compare_exchange_strong(word, encode(goal, pos, mapper),
+                                      std::memory_order_relaxed))
+        return true;
+    expected = decode(word, pos, mapper);
+    return false;
+}
+
+template <class K, class D, bool m, class A, bool iu, bool sh>
+template <class Mapper, class F, class... Types>
+std::pair<typename complex_slot<K, D, m, A, iu, sh>::slot_type, bool>
+complex_slot<K, D, m, A, iu, sh>::atomic_slot_type::non_atomic_update_at(
+    size_t pos, const Mapper& mapper, F f, Types&&... args)
+{
+    auto result = non_atomic_update(f, std::forward<Types>(args)...);
+    return std::make_pair(decode(result.first._mfptr.full, pos, mapper), true);
+}
+
 } // namespace growt
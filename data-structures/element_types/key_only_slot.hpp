@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdlib.h>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <atomic>
+
+#include "utils/concurrency/memory_order.hpp"
+#include "utils/debug.hpp"
+namespace debug = utils_tm::debug_tm;
+
+#include "data-structures/returnelement.hpp"
+
+namespace growt
+{
+
+// mapped_type of hash sets (table_config<Key, void, ...>), all values are equal
+struct empty_mapped_type
+{
+    bool operator==(const empty_mapped_type&) const = default;
+};
+
+// Slot for hash sets with unsigned integral keys. Only the key is stored (one
+// word of sizeof(Key) bytes), therefore, all changes are single word CAS
+// operations. The highest key bit is reserved as the mark bit (if markable),
+// i.e., keys have to be below 2^(bits-1) (checked in debug builds).
+template <class Key,
+          bool markable     = false,
+          Key  delete_dummy = static_cast<Key>(
+              (Key(1) << (sizeof(Key) * 8 - 1)) - 1)>
+class key_only_slot
+{
+  private:
+    using memo = utils_tm::concurrency_tm::standard_memory_order_policy;
+    static_assert(std::is_integral<Key>::value,
+                  "key_only_slot can only be used with integral keys");
+    static_assert(std::is_unsigned_v<Key>,
+                  "key_only_slot can only be used with unsigned keys");
+
+    static constexpr Key marked_bit = Key(1) << (sizeof(Key) * 8 - 1);
+    static constexpr Key bitmask    = (markable) ? marked_bit - 1 : ~Key(0);
+
+    static inline Key checked_key(Key k)
+    {
+        if constexpr (markable)
+            debug::if_debug("key_only_slot: key uses the mark bit",
+                            (k & marked_bit) != 0);
+        return k;
+    }
+
+  public:
+    using key_type    = Key;
+    using mapped_type = empty_mapped_type;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    static constexpr bool allows_marking               = markable;
+    static constexpr bool allows_deletions             = true;
+    static constexpr bool allows_atomic_updates        = false;
+    static constexpr bool allows_updates               = false;
+    static constexpr bool allows_referential_integrity = false;
+    static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
+    static constexpr bool stores_hash                  = false;
+
+    class atomic_slot_type;
+
+    // THIS IS AFTER THE ELEMENT IS READ (i.e. consistency within one query)
+    class slot_type
+    {
+      private:
+        key_type key;
+
+        friend class atomic_slot_type;
+
+      public:
+        slot_type(const key_type& k, const mapped_type& d, size_t hash = 0);
+        slot_type(const value_type& pair, size_t hash = 0);
+        slot_type(key_type&& k, mapped_type&& d, size_t hash = 0);
+        slot_type(value_type&& pair, size_t hash = 0);
+        constexpr slot_type(key_type source) : key(source) {}
+
+        slot_type(const slot_type& source)                = default;
+        slot_type(slot_type&& source) noexcept            = default;
+        slot_type& operator=(const slot_type& source)     = default;
+        slot_type& operator=(slot_type&& source) noexcept = default;
+        ~slot_type()                                      = default;
+
+        inline key_type        get_key() const;
+        inline const key_type& get_key_ref() const;
+        inline mapped_type     get_mapped() const;
+        inline void            set_mapped(const mapped_type& m);
+        inline void            set_fingerprint(size_t) const;
+
+        inline bool is_empty() const;
+        inline bool is_deleted() const;
+        inline bool is_marked() const;
+        inline bool compare_key(const key_type& k, size_t hash) const;
+        inline void cleanup() const
+        { /* the key only version does not need cleanup */
+        }
+
+        inline      operator value_type() const;
+        inline bool operator==(const slot_type& r) const;
+        inline bool operator!=(const slot_type& r) const;
+    };
+
+    static_assert(sizeof(slot_type) == sizeof(Key),
+                  "sizeof(slot_type) in key_only_slot is unexpected");
+
+    // THIS IS IN THE TABLE, IT ONLY HAS THE CAS+UPDATE STUFF
+    class atomic_slot_type
+    {
+      private:
+        std::atomic<key_type> _key;
+
+      public:
+        atomic_slot_type(const atomic_slot_type& source);
+        atomic_slot_type& operator=(const atomic_slot_type& source);
+        atomic_slot_type(const slot_type& source);
+        atomic_slot_type& operator=(const slot_type& source);
+        ~atomic_slot_type() = default;
+
+        slot_type load() const;
+        void      non_atomic_set(const slot_type& goal);
+        bool      cas(slot_type& expected, slot_type goal);
+        bool      atomic_delete(slot_type& expected);
+        bool      atomic_mark(slot_type& expected);
+
+        // there is nothing to update in a set, updates only find the element
+        template <class F, class... Types>
+        std::pair<slot_type, bool>
+        atomic_update(slot_type& expected, F f, Types&&... args);
+        template <class F, class... Types>
+        std::pair<slot_type, bool> non_atomic_update(F f, Types&&... args);
+    };
+
+    static_assert(std::atomic<key_type>::is_always_lock_free,
+                  "key_only_slot atomic is not lock free");
+
+    static constexpr slot_type get_empty() { return slot_type(key_type()); }
+    static constexpr slot_type get_deleted() { return slot_type(delete_dummy); }
+
+    static std::string name() { return "key_only_slot"; }
+};
+
+
+// SLOT_TYPE *******************************************************************
+// *** constructors ************************************************************
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::slot_type::slot_type(const key_type& k,
+                                              const mapped_type&,
+                                              [[maybe_unused]] size_t hash)
+    : key(checked_key(k))
+{
+}
+
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::slot_type::slot_type(const value_type& pair,
+                                              [[maybe_unused]] size_t hash)
+    : key(checked_key(pair.first))
+{
+}
+
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::slot_type::slot_type(key_type&& k,
+                                              mapped_type&&,
+                                              [[maybe_unused]] size_t hash)
+    : key(checked_key(k))
+{
+}
+
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::slot_type::slot_type(value_type&& pair,
+                                              [[maybe_unused]] size_t hash)
+    : key(checked_key(pair.first))
+{
+}
+
+
+// *** getter ******************************************************************
+template <class K, bool m, K dd>
+typename key_only_slot<K, m, dd>::key_type
+key_only_slot<K, m, dd>::slot_type::get_key() const
+{
+    return key & key_only_slot::bitmask;
+}
+
+template <class K, bool m, K dd>
+const typename key_only_slot<K, m, dd>::key_type&
+key_only_slot<K, m, dd>::slot_type::get_key_ref() const
+{
+    return key;
+}
+
+template <class K, bool m, K dd>
+typename key_only_slot<K, m, dd>::mapped_type
+key_only_slot<K, m, dd>::slot_type::get_mapped() const
+{
+    return mapped_type();
+}
+
+template <class K, bool m, K dd>
+void key_only_slot<K, m, dd>::slot_type::set_mapped(const mapped_type&)
+{
+}
+
+template <class K, bool m, K dd>
+void key_only_slot<K, m, dd>::slot_type::set_fingerprint(size_t) const
+{
+}
+
+// *** state *******************************************************************
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::is_empty() const
+{
+    return (key & bitmask) == 0;
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::is_deleted() const
+{
+    return (key & bitmask) == dd;
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::is_marked() const
+{
+    if constexpr (!m) return false;
+    return key & marked_bit;
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::compare_key(
+    const key_type& k, [[maybe_unused]] size_t hash) const
+{
+    return (key & bitmask) == k;
+}
+
+
+// *** operators ***************************************************************
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::slot_type::operator value_type() const
+{
+    return std::make_pair(get_key(), mapped_type());
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::operator==(const slot_type& r) const
+{
+    return key == r.key;
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::slot_type::operator!=(const slot_type& r) const
+{
+    return key != r.key;
+}
+
+
+
+// ATOMIC_SLOT_TYPE ************************************************************
+// *** constructors ************************************************************
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::atomic_slot_type::atomic_slot_type(
+    const atomic_slot_type& source)
+    : _key(source._key.load(memo::acquire))
+{
+}
+
+template <class K, bool m, K dd>
+typename key_only_slot<K, m, dd>::atomic_slot_type&
+key_only_slot<K, m, dd>::atomic_slot_type::operator=(
+    const atomic_slot_type& source)
+{
+    _key = source._key.load(memo::acquire);
+    return *this;
+}
+
+template <class K, bool m, K dd>
+key_only_slot<K, m, dd>::atomic_slot_type::atomic_slot_type(
+    const slot_type& source)
+    : _key(source.key)
+{
+}
+
+template <class K, bool m, K dd>
+typename key_only_slot<K, m, dd>::atomic_slot_type&
+key_only_slot<K, m, dd>::atomic_slot_type::operator=(const slot_type& source)
+{
+    non_atomic_set(source);
+    return *this;
+}
+
+// *** common atomics **********************************************************
+template <class K, bool m, K dd>
+typename key_only_slot<K, m, dd>::slot_type
+key_only_slot<K, m, dd>::atomic_slot_type::load() const
+{
+    return slot_type(_key.load(memo::acquire));
+}
+
+template <class K, bool m, K dd>
+void key_only_slot<K, m, dd>::atomic_slot_type::non_atomic_set(
+    const slot_type& goal)
+{
+    _key.store(goal.key, std::memory_order_relaxed);
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::atomic_slot_type::cas(slot_type& expected,
+                                                    slot_type  goal)
+{
+    return _key.compare_exchange_strong(expected.key, goal.key, memo::acq_rel);
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::atomic_slot_type::atomic_delete(
+    slot_type& expected)
+{
+    return cas(expected, get_deleted());
+}
+
+template <class K, bool m, K dd>
+bool key_only_slot<K, m, dd>::atomic_slot_type::atomic_mark(
+    slot_type& expected)
+{
+    if constexpr (!m) return true;
+    auto temp = expected;
+    temp.key |= marked_bit;
+    return cas(expected, temp);
+}
+
+// *** functor style updates ***************************************************
+template <class K, bool m, K dd>
+template <class F, class... Types>
+std::pair<typename key_only_slot<K, m, dd>::slot_type, bool>
+key_only_slot<K, m, dd>::atomic_slot_type::atomic_update(
+    slot_type& expected, [[maybe_unused]] F f, [[maybe_unused]] Types&&... args)
+{
+    return std::make_pair(expected, true);
+}
+
+template <class K, bool m, K dd>
+template <class F, class... Types>
+std::pair<typename key_only_slot<K, m, dd>::slot_type, bool>
+key_only_slot<K, m, dd>::atomic_slot_type::non_atomic_update(
+    [[maybe_unused]] F f, [[maybe_unused]] Types&&... args)
+{
+    return std::make_pair(load(), true);
+}
+} // namespace growt
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdlib.h>
+#include <string>
+#include <tuple>
+
+#include <atomic>
+
+#include "utils/concurrency/memory_order.hpp"
+#include "utils/debug.hpp"
+namespace debug = utils_tm::debug_tm;
+
+#include "data-structures/returnelement.hpp"
+
+namespace growt
+{
+
+// used to declare bit widths in the table_config
+// (i.e. table_config<packed_bits<40>, packed_bits<23>, ...>)
+template <size_t Bits>
+struct packed_bits
+{
+};
+
+// Slot that packs a key of KeyBits bits and a value of ValueBits bits into
+// one 64 bit word:  [mark (if markable)] ... [value] [key]
+// Keys have to be smaller than 2^KeyBits (they are not truncated, larger keys
+// would alias other keys, this is checked in debug builds). The key 0 encodes
+// empty slots and the largest key (all KeyBits set) encodes deleted slots,
+// both cannot be inserted. Values are truncated to ValueBits.
+template <size_t KeyBits, size_t ValueBits, bool markable = false>
+class packed_slot
+{
+  private:
+    using memo = utils_tm::concurrency_tm::standard_memory_order_policy;
+
+    static_assert(KeyBits > 1 && ValueBits > 0 &&
+                      KeyBits + ValueBits + size_t(markable) <= 64,
+                  "packed_slot: key and value bits do not fit into one word");
+
+    static constexpr uint64_t key_mask =
+        (KeyBits == 64) ? ~uint64_t(0) : (uint64_t(1) << KeyBits) - 1;
+    static constexpr uint64_t value_mask =
+        (ValueBits == 64) ? ~uint64_t(0) : (uint64_t(1) << ValueBits) - 1;
+    static constexpr size_t   value_shift = KeyBits;
+    static constexpr uint64_t marked_bit  = uint64_t(1) << 63;
+
+  public:
+    using key_type    = uint64_t;
+    using mapped_type = uint64_t;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    static constexpr size_t key_bits   = KeyBits;
+    static constexpr size_t value_bits = ValueBits;
+
+    static constexpr bool allows_marking               = markable;
+    static constexpr bool allows_deletions             = true;
+    static constexpr bool allows_atomic_updates        = true;
+    static constexpr bool allows_updates               = true;
+    static constexpr bool allows_referential_integrity = false;
+    static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
+    static constexpr bool stores_hash                  = false;
+
+    class atomic_slot_type;
+
+    // THIS IS AFTER THE ELEMENT IS READ (i.e. consistency within one query)
+    // (the key is decoded once, such that it can be referenced)
+    class slot_type
+    {
+      private:
+        uint64_t _word;
+        key_type _key;
+
+        friend class atomic_slot_type;
+
+      public:
+        slot_type(const key_type& k, const mapped_type& d, size_t hash = 0);
+        slot_type(const value_type& pair, size_t hash = 0);
+        slot_type(key_type&& k, mapped_type&& d, size_t hash = 0);
+        slot_type(value_type&& pair, size_t hash = 0);
+        constexpr slot_type(uint64_t word)
+            : _word(word), _key(word & key_mask)
+        {
+        }
+
+        slot_type(const slot_type& source)                = default;
+        slot_type(slot_type&& source) noexcept            = default;
+        slot_type& operator=(const slot_type& source)     = default;
+        slot_type& operator=(slot_type&& source) noexcept = default;
+        ~slot_type()                                      = default;
+
+        inline key_type        get_key() const;
+        inline const key_type& get_key_ref() const;
+        inline mapped_type     get_mapped() const;
+        inline void            set_mapped(const mapped_type& m);
+        inline void            set_fingerprint(size_t) const;
+
+        inline bool is_empty() const;
+        inline bool is_deleted() const;
+        inline bool is_marked() const;
+        inline bool compare_key(const key_type& k, size_t hash) const;
+        inline void cleanup() const
+        { /* the packed version does not need cleanup */
+        }
+
+        inline      operator value_type() const;
+        inline bool operator==(const slot_type& r) const;
+        inline bool operator!=(const slot_type& r) const;
+    };
+
+    // THIS IS IN THE TABLE, IT ONLY HAS THE CAS+UPDATE STUFF
+    class atomic_slot_type
+    {
+      private:
+        std::atomic_uint64_t _raw_data;
+
+      public:
+        atomic_slot_type(const atomic_slot_type& source);
+        atomic_slot_type& operator=(const atomic_slot_type& source);
+        atomic_slot_type(const slot_type& source);
+        atomic_slot_type& operator=(const slot_type& source);
+        ~atomic_slot_type() = default;
+
+        slot_type load() const;
+        void      non_atomic_set(const slot_type& goal);
+        bool      cas(slot_type& expected, slot_type goal);
+        bool      atomic_delete(slot_type& expected);
+        bool      atomic_mark(slot_type& expected);
+
+        template <class F, class... Types>
+        std::pair<slot_type, bool>
+        atomic_update(slot_type& expected, F f, Types&&... args);
+        template <class F, class... Types>
+        std::pair<slot_type, bool> non_atomic_update(F f, Types&&... args);
+    };
+
+    static_assert(sizeof(atomic_slot_type) == 8,
+                  "sizeof(atomic_slot_type) in packed_slot is unexpected");
+
+    static constexpr slot_type get_empty() { return slot_type(uint64_t(0)); }
+    static constexpr slot_type get_deleted() { return slot_type(key_mask); }
+
+    static std::string name()
+    {
+        return "packed_slot" + std::to_string(KeyBits) + "_" +
+               std::to_string(ValueBits);
+    }
+
+  private:
+    static inline uint64_t pack(key_type k, mapped_type d)
+    {
+        debug::if_debug("packed_slot: key does not fit into KeyBits",
+                        (k & ~key_mask) != 0);
+        return (k & key_mask) | ((d & value_mask) << value_shift);
+    }
+};
+
+
+// SLOT_TYPE *******************************************************************
+// *** constructors ************************************************************
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::slot_type::slot_type(const key_type&    k,
+                                             const mapped_type& d,
+                                             [[maybe_unused]] size_t hash)
+    : slot_type(pack(k, d))
+{
+}
+
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::slot_type::slot_type(const value_type& pair,
+                                             [[maybe_unused]] size_t hash)
+    : slot_type(pack(pair.first, pair.second))
+{
+}
+
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::slot_type::slot_type(key_type&&    k,
+                                             mapped_type&& d,
+                                             [[maybe_unused]] size_t hash)
+    : slot_type(pack(k, d))
+{
+}
+
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::slot_type::slot_type(value_type&& pair,
+                                             [[maybe_unused]] size_t hash)
+    : slot_type(pack(pair.first, pair.second))
+{
+}
+
+
+// *** getter ******************************************************************
+template <size_t kb, size_t vb, bool m>
+typename packed_slot<kb, vb, m>::key_type
+packed_slot<kb, vb, m>::slot_type::get_key() const
+{
+    return _key;
+}
+
+template <size_t kb, size_t vb, bool m>
+const typename packed_slot<kb, vb, m>::key_type&
+packed_slot<kb, vb, m>::slot_type::get_key_ref() const
+{
+    return _key;
+}
+
+template <size_t kb, size_t vb, bool m>
+typename packed_slot<kb, vb, m>::mapped_type
+packed_slot<kb, vb, m>::slot_type::get_mapped() const
+{
+    return (_word >> value_shift) & value_mask;
+}
+
+template <size_t kb, size_t vb, bool m>
+void packed_slot<kb, vb, m>::slot_type::set_mapped(const mapped_type& mapped)
+{
+    _word = (_word & ~(value_mask << value_shift)) |
+            ((mapped & value_mask) << value_shift);
+}
+
+template <size_t kb, size_t vb, bool m>
+void packed_slot<kb, vb, m>::slot_type::set_fingerprint(size_t) const
+{
+}
+
+// *** state *******************************************************************
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::is_empty() const
+{
+    return _key == 0;
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::is_deleted() const
+{
+    return _key == key_mask;
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::is_marked() const
+{
+    if constexpr (!m) return false;
+    return _word & marked_bit;
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::compare_key(
+    const key_type& k, [[maybe_unused]] size_t hash) const
+{
+    return _key == k;
+}
+
+
+// *** operators ***************************************************************
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::slot_type::operator value_type() const
+{
+    return std::make_pair(get_key(), get_mapped());
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::operator==(const slot_type& r) const
+{
+    return _key == r._key;
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::slot_type::operator!=(const slot_type& r) const
+{
+    return _key != r._key;
+}
+
+
+
+// ATOMIC_SLOT_TYPE ************************************************************
+// *** constructors ************************************************************
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::atomic_slot_type::atomic_slot_type(
+    const atomic_slot_type& source)
+    : _raw_data(source._raw_data.load(memo::acquire))
+{
+}
+
+template <size_t kb, size_t vb, bool m>
+typename packed_slot<kb, vb, m>::atomic_slot_type&
+packed_slot<kb, vb, m>::atomic_slot_type::operator=(
+    const atomic_slot_type& source)
+{
+    _raw_data = source._raw_data.load(memo::acquire);
+    return *this;
+}
+
+template <size_t kb, size_t vb, bool m>
+packed_slot<kb, vb, m>::atomic_slot_type::atomic_slot_type(
+    const slot_type& source)
+    : _raw_data(source._word)
+{
+}
+
+template <size_t kb, size_t vb, bool m>
+typename packed_slot<kb, vb, m>::atomic_slot_type&
+packed_slot<kb, vb, m>::atomic_slot_type::operator=(const slot_type& source)
+{
+    non_atomic_set(source);
+    return *this;
+}
+
+// *** common atomics **********************************************************
+template <size_t kb, size_t vb, bool m>
+typename packed_slot<kb, vb, m>::slot_type
+packed_slot<kb, vb, m>::atomic_slot_type::load() const
+{
+    return slot_type(_raw_data.load(memo::acquire));
+}
+
+template <size_t kb, size_t vb, bool m>
+void packed_slot<kb, vb, m>::atomic_slot_type::non_atomic_set(
+    const slot_type& goal)
+{
+    _raw_data.store(goal._word, std::memory_order_relaxed);
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::atomic_slot_type::cas(slot_type& expected,
+                                                   slot_type  goal)
+{
+    if (_raw_data.compare_exchange_strong(expected._word, goal._word,
+                                          memo::acq_rel))
+        return true;
+    expected = slot_type(expected._word);
+    return false;
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::atomic_slot_type::atomic_delete(
+    slot_type& expected)
+{
+    return cas(expected, get_deleted());
+}
+
+template <size_t kb, size_t vb, bool m>
+bool packed_slot<kb, vb, m>::atomic_slot_type::atomic_mark(slot_type& expected)
+{
+    if constexpr (!m) return true;
+    auto temp = slot_type(expected._word | marked_bit);
+    return cas(expected, temp);
+}
+
+// *** functor style updates ***************************************************
+// (the whole word is exchanged, therefore, updates fail on marked slots)
+template <size_t kb, size_t vb, bool m>
+template <class F, class... Types>
+std::pair<typename packed_slot<kb, vb, m>::slot_type, bool>
+packed_slot<kb, vb, m>::atomic_slot_type::atomic_update(slot_type& expected,
+                                                        F          f,
+                                                        Types&&... args)
+{
+    auto mapped = expected.get_mapped();
+    f(mapped, std::forward<Types>(args)...);
+    auto temp = expected;
+    temp.set_mapped(mapped);
+    return std::make_pair(temp, cas(expected, temp));
+}
+
+template <size_t kb, size_t vb, bool m>
+template <class F, class... Types>
+std::pair<typename packed_slot<kb, vb, m>::slot_type, bool>
+packed_slot<kb, vb, m>::atomic_slot_type::non_atomic_update(F f,
+                                                            Types&&... args)
+{
+    // NON-ATOMIC-UPDATES ARE INHERENTLY UNSAFE
+    auto temp   = load();
+    auto mapped = temp.get_mapped();
+    f(mapped, std::forward<Types>(args)...);
+    temp.set_mapped(mapped);
+    non_atomic_set(temp);
+    return std::make_pair(temp, true);
+}
+} // namespace growt
@@ -0,0 +1,590 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdlib.h>
+#include <string>
+#include <tuple>
+
+#include <atomic>
+
+#include "utils/concurrency/memory_order.hpp"
+#include "utils/debug.hpp"
+namespace debug = utils_tm::debug_tm;
+
+#include "data-structures/returnelement.hpp"
+
+namespace growt
+{
+
+// used to declare quotiented keys in the table_config
+// (i.e. table_config<quotient_bits<40, 24>, packed_bits<23>,
+//                    quotient_hash<40>, ...>)
+// the table will never be smaller than 2^MinQuotientBits slots
+template <size_t KeyBits, size_t MinQuotientBits = 9>
+struct quotient_bits
+{
+};
+
+// Invertible hash function for keys with KeyBits bits. The key is permuted
+// (xorshift-multiply rounds modulo 2^KeyBits), the result is placed in the
+// top KeyBits bits of the hash (these are the bits used by
+// mapper_type::map).
+template <size_t KeyBits>
+class quotient_hash
+{
+  private:
+    static_assert(KeyBits > 1 && KeyBits <= 64,
+                  "quotient_hash: unsupported number of key bits");
+
+    static constexpr uint64_t mask =
+        (KeyBits == 64) ? ~uint64_t(0) : (uint64_t(1) << KeyBits) - 1;
+    // x ^= x >> shift is its own inverse, since 2*shift >= KeyBits
+    static constexpr size_t   shift   = (KeyBits + 1) / 2;
+    static constexpr uint64_t factor0 = 0xff51afd7ed558ccdull;
+    static constexpr uint64_t factor1 = 0xc4ceb9fe1a85ec53ull;
+
+    // multiplicative inverse modulo 2^64 (newton iteration)
+    static constexpr uint64_t invert(uint64_t a)
+    {
+        uint64_t x = a;
+        for (size_t i = 0; i < 5; ++i) x *= 2 - a * x;
+        return x;
+    }
+    static constexpr uint64_t inverse0 = invert(factor0);
+    static constexpr uint64_t inverse1 = invert(factor1);
+
+  public:
+    static constexpr size_t significant_digits = KeyBits;
+
+    inline uint64_t operator()(uint64_t k) const
+    {
+        k &= mask;
+        k ^= k >> shift;
+        k = (k * factor0) & mask;
+        k ^= k >> shift;
+        k = (k * factor1) & mask;
+        k ^= k >> shift;
+        return k << (64 - KeyBits);
+    }
+
+    inline uint64_t inverse(uint64_t hash) const
+    {
+        auto k = hash >> (64 - KeyBits);
+        k ^= k >> shift;
+        k = (k * inverse1) & mask;
+        k ^= k >> shift;
+        k = (k * inverse0) & mask;
+        k ^= k >> shift;
+        return k;
+    }
+};
+
+// Slot for keys of KeyBits bits hashed with an invertible hash function
+// (hash(k) has to use only the top KeyBits bits). The top bits of the hash
+// are the home slot of the element, therefore, they are implicit in its
+// position. The slot only stores the remaining KeyBits-MinQuotientBits hash
+// bits, together with the displacement from the home slot (8 bits) and the
+// value in one 64 bit word:
+//     [mark (if markable)] ... [value] [displacement+1] [remainder]
+// The displacement field 0 encodes empty slots, all ones encodes deleted
+// slots (no key is reserved). Elements cannot be displaced further than
+// max_displacement (inserts report a full table).
+//
+// Keys are only reconstructed, when the slot is loaded with its position
+// (see base_linear::load_slot), unpositioned loads/changes (marking,
+// deleting, updating) work on the raw word and keep the key bits intact.
+template <size_t KeyBits,
+          size_t ValueBits,
+          size_t MinQuotientBits = 9,
+          class Hash             = quotient_hash<KeyBits>,
+          bool markable          = false>
+class quotient_slot
+{
+  private:
+    using memo = utils_tm::concurrency_tm::standard_memory_order_policy;
+
+    static constexpr size_t remainder_bits    = KeyBits - MinQuotientBits;
+    static constexpr size_t displacement_bits = 8;
+    static constexpr size_t displacement_shift = remainder_bits;
+    static constexpr size_t value_shift = remainder_bits + displacement_bits;
+
+    static_assert(MinQuotientBits > 0 && MinQuotientBits < KeyBits,
+                  "quotient_slot: the quotient has to be part of the key");
+    static_assert(ValueBits > 0 && value_shift + ValueBits +
+                                           size_t(markable) <= 64,
+                  "quotient_slot: remainder, displacement, and value bits do "
+                  "not fit into one word");
+
+    static constexpr uint64_t remainder_mask =
+        (uint64_t(1) << remainder_bits) - 1;
+    static constexpr uint64_t displacement_mask =
+        ((uint64_t(1) << displacement_bits) - 1) << displacement_shift;
+    static constexpr uint64_t key_fields_mask =
+        (uint64_t(1) << value_shift) - 1;
+    static constexpr uint64_t value_mask =
+        (ValueBits == 64) ? ~uint64_t(0) : (uint64_t(1) << ValueBits) - 1;
+    static constexpr uint64_t marked_bit = uint64_t(1) << 63;
+
+  public:
+    using key_type      = uint64_t;
+    using mapped_type   = uint64_t;
+    using value_type    = std::pair<const key_type, mapped_type>;
+    using hash_fct_type = Hash;
+
+    static constexpr size_t key_bits   = KeyBits;
+    static constexpr size_t value_bits = ValueBits;
+    // tables are never smaller than this (to fit the remainder bits)
+    static constexpr size_t min_capacity = size_t(1) << MinQuotientBits;
+    static constexpr size_t max_displacement =
+        (size_t(1) << displacement_bits) - 3;
+
+    static constexpr bool allows_marking               = markable;
+    static constexpr bool allows_deletions             = true;
+    static constexpr bool allows_atomic_updates        = true;
+    static constexpr bool allows_updates               = true;
+    static constexpr bool allows_referential_integrity = false;
+    static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = true;
+    static constexpr bool stores_hash                  = true;
+
+    class atomic_slot_type;
+
+    // THIS IS AFTER THE ELEMENT IS READ (i.e. consistency within one query)
+    // (the hash is reconstructed on a positioned load, the key is computed
+    // lazily from the hash)
+    class slot_type
+    {
+      private:
+        uint64_t         _word;
+        size_t           _hash;
+        mutable key_type _key;
+        mutable bool     _has_key;
+
+        friend class atomic_slot_type;
+
+      public:
+        slot_type(const key_type& k, const mapped_type& d, size_t hash = 0);
+        slot_type(const value_type& pair, size_t hash = 0);
+        slot_type(key_type&& k, mapped_type&& d, size_t hash = 0);
+        slot_type(value_type&& pair, size_t hash = 0);
+        constexpr slot_type(uint64_t word)
+            : _word(word), _hash(0), _key(0), _has_key(false)
+        {
+        }
+
+        slot_type(const slot_type& source)                = default;
+        slot_type(slot_type&& source) noexcept            = default;
+        slot_type& operator=(const slot_type& source)     = default;
+        slot_type& operator=(slot_type&& source) noexcept = default;
+        ~slot_type()                                      = default;
+
+        inline key_type        get_key() const;
+        inline const key_type& get_key_ref() const;
+        // a positioned load reconstructs the whole hash (migrations reuse it)
+        inline size_t get_hash() const { return _hash; }
+        inline size_t hash_bits() const { return 64; }
+        inline mapped_type     get_mapped() const;
+        inline void            set_mapped(const mapped_type& m);
+        inline void            set_fingerprint(size_t) const;
+
+        inline bool is_empty() const;
+        inline bool is_deleted() const;
+        inline bool is_marked() const;
+        inline bool compare_key(const key_type& k, size_t hash) const;
+        inline void cleanup() const
+        { /* the quotient version does not need cleanup */
+        }
+
+        inline      operator value_type() const;
+        inline bool operator==(const slot_type& r) const;
+        inline bool operator!=(const slot_type& r) const;
+    };
+
+    // THIS IS IN THE TABLE, IT ONLY HAS THE CAS+UPDATE STUFF
+    class atomic_slot_type
+    {
+      private:
+        std::atomic_uint64_t _raw_data;
+
+        template <class Mapper>
+        static uint64_t encode(const slot_type& goal,
+                               size_t           pos,
+                               const Mapper&    mapper);
+        template <class Mapper>
+        static slot_type
+        decode(uint64_t word, size_t pos, const Mapper& mapper);
+
+      public:
+        atomic_slot_type(const atomic_slot_type& source);
+        atomic_slot_type& operator=(const atomic_slot_type& source);
+        atomic_slot_type(const slot_type& source);
+        atomic_slot_type& operator=(const slot_type& source);
+        ~atomic_slot_type() = default;
+
+        // unpositioned accesses (the key is not reconstructed/written)
+        slot_type load() const;
+        void      non_atomic_set(const slot_type& goal);
+        bool      cas(slot_type& expected, slot_type goal);
+        bool      atomic_delete(slot_type& expected);
+        bool      atomic_mark(slot_type& expected);
+
+        template <class F, class... Types>
+        std::pair<slot_type, bool>
+        atomic_update(slot_type& expected, F f, Types&&... args);
+        template <class F, class... Types>
+        std::pair<slot_type, bool> non_atomic_update(F f, Types&&... args);
+
+        // positioned accesses (pos is the index of this slot)
+        template <class Mapper>
+        slot_type load(size_t pos, const Mapper& mapper) const;
+        template <class Mapper>
+        void non_atomic_set(const slot_type& goal,
+                            size_t           pos,
+                            const Mapper&    mapper);
+        template <class Mapper>
+        bool cas(slot_type&       expected,
+                 const slot_type& goal,
+                 size_t           pos,
+                 const Mapper&    mapper);
+        template <class Mapper, class F, class... Types>
+        std::pair<slot_type, bool> non_atomic_update_at(size_t        pos,
+                                                        const Mapper& mapper,
+                                                        F             f,
+                                                        Types&&... args);
+    };
+
+    static_assert(sizeof(atomic_slot_type) == 8,
+                  "sizeof(atomic_slot_type) in quotient_slot is unexpected");
+
+    static constexpr slot_type get_empty() { return slot_type(uint64_t(0)); }
+    static constexpr slot_type get_deleted()
+    {
+        return slot_type(displacement_mask);
+    }
+
+    static std::string name()
+    {
+        return "quotient_slot" + std::to_string(KeyBits) + "_" +
+               std::to_string(ValueBits) + "_q" +
+               std::to_string(MinQuotientBits);
+    }
+};
+
+
+// SLOT_TYPE *******************************************************************
+// *** constructors ************************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::slot_type::slot_type(const key_type&    k,
+                                                      const mapped_type& d,
+                                                      size_t             hash)
+    : _word((d & value_mask) << value_shift), _hash(hash ? hash : H()(k)),
+      _key(k), _has_key(true)
+{
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::slot_type::slot_type(const value_type& pair,
+                                                      size_t            hash)
+    : slot_type(pair.first, pair.second, hash)
+{
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::slot_type::slot_type(key_type&&    k,
+                                                      mapped_type&& d,
+                                                      size_t        hash)
+    : slot_type(k, d, hash)
+{
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::slot_type::slot_type(value_type&& pair,
+                                                      size_t       hash)
+    : slot_type(pair.first, pair.second, hash)
+{
+}
+
+
+// *** getter ******************************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+typename quotient_slot<kb, vb, mq, H, m>::key_type
+quotient_slot<kb, vb, mq, H, m>::slot_type::get_key() const
+{
+    return get_key_ref();
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+const typename quotient_slot<kb, vb, mq, H, m>::key_type&
+quotient_slot<kb, vb, mq, H, m>::slot_type::get_key_ref() const
+{
+    if (!_has_key)
+    {
+        _key     = H().inverse(_hash);
+        _has_key = true;
+    }
+    return _key;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+typename quotient_slot<kb, vb, mq, H, m>::mapped_type
+quotient_slot<kb, vb, mq, H, m>::slot_type::get_mapped() const
+{
+    return (_word >> value_shift) & value_mask;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+void quotient_slot<kb, vb, mq, H, m>::slot_type::set_mapped(
+    const mapped_type& mapped)
+{
+    _word = (_word & ~(value_mask << value_shift)) |
+            ((mapped & value_mask) << value_shift);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+void quotient_slot<kb, vb, mq, H, m>::slot_type::set_fingerprint(size_t) const
+{
+}
+
+// *** state *******************************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::is_empty() const
+{
+    return (_word & displacement_mask) == 0;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::is_deleted() const
+{
+    return (_word & displacement_mask) == displacement_mask;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::is_marked() const
+{
+    if constexpr (!m) return false;
+    return _word & marked_bit;
+}
+
+// the hash function is a bijection, therefore, comparing hashes suffices
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::compare_key(
+    [[maybe_unused]] const key_type& k, size_t hash) const
+{
+    return _hash == hash && !is_empty() && !is_deleted();
+}
+
+
+// *** operators ***************************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::slot_type::operator value_type() const
+{
+    return std::make_pair(get_key(), get_mapped());
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::operator==(
+    const slot_type& r) const
+{
+    return _hash == r._hash;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::slot_type::operator!=(
+    const slot_type& r) const
+{
+    return _hash != r._hash;
+}
+
+
+
+// ATOMIC_SLOT_TYPE ************************************************************
+// *** constructors ************************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::atomic_slot_type(
+    const atomic_slot_type& source)
+    : _raw_data(source._raw_data.load(memo::acquire))
+{
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+typename quotient_slot<kb, vb, mq, H, m>::atomic_slot_type&
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::operator=(
+    const atomic_slot_type& source)
+{
+    _raw_data = source._raw_data.load(memo::acquire);
+    return *this;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::atomic_slot_type(
+    const slot_type& source)
+    : _raw_data(source._word)
+{
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+typename quotient_slot<kb, vb, mq, H, m>::atomic_slot_type&
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::operator=(
+    const slot_type& source)
+{
+    non_atomic_set(source);
+    return *this;
+}
+
+// *** encoding ****************************************************************
+// the home slot is the top part of the hash (hash >> shift), the remainder is
+// the part below it (down to the significant KeyBits)
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper>
+uint64_t quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::encode(
+    const slot_type& goal, size_t pos, const Mapper& mapper)
+{
+    auto shift = mapper.right_shift();
+    auto home  = mapper.map(goal._hash);
+    auto disp  = mapper.remap(pos - home);
+    // inserts check the displacement beforehand (see
+    // base_linear::displacement_fits)
+    if (disp > max_displacement)
+        debug::if_debug("quotient_slot: displacement overflow");
+
+    auto rem = (goal._hash & ((uint64_t(1) << shift) - 1)) >> (64 - kb);
+    return (goal._word & ~key_fields_mask) | rem |
+           (uint64_t(disp + 1) << displacement_shift);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper>
+typename quotient_slot<kb, vb, mq, H, m>::slot_type
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::decode(
+    uint64_t word, size_t pos, const Mapper& mapper)
+{
+    auto temp = slot_type(word);
+    if (temp.is_empty() || temp.is_deleted()) return temp;
+
+    auto disp  = ((word & displacement_mask) >> displacement_shift) - 1;
+    auto home  = mapper.remap(pos - disp);
+    temp._hash = (home << mapper.right_shift()) |
+                 ((word & remainder_mask) << (64 - kb));
+    return temp;
+}
+
+// *** common atomics **********************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+typename quotient_slot<kb, vb, mq, H, m>::slot_type
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::load() const
+{
+    return slot_type(_raw_data.load(memo::acquire));
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+void quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::non_atomic_set(
+    const slot_type& goal)
+{
+    _raw_data.store(goal._word, std::memory_order_relaxed);
+}
+
+// only the value and the mark are taken from goal (used by references)
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::cas(
+    slot_type& expected, slot_type goal)
+{
+    auto temp = (expected._word & key_fields_mask) |
+                (goal._word & ~key_fields_mask);
+    return _raw_data.compare_exchange_strong(expected._word, temp,
+                                             memo::acq_rel);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::atomic_delete(
+    slot_type& expected)
+{
+    return _raw_data.compare_exchange_strong(
+        expected._word, get_deleted()._word, memo::acq_rel);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+bool quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::atomic_mark(
+    slot_type& expected)
+{
+    if constexpr (!m) return true;
+    return _raw_data.compare_exchange_strong(
+        expected._word, expected._word | marked_bit, memo::acq_rel);
+}
+
+// *** functor style updates ***************************************************
+// (the whole word is exchanged, therefore, updates fail on marked slots)
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class F, class... Types>
+std::pair<typename quotient_slot<kb, vb, mq, H, m>::slot_type, bool>
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::atomic_update(
+    slot_type& expected, F f, Types&&... args)
+{
+    auto mapped = expected.get_mapped();
+    f(mapped, std::forward<Types>(args)...);
+    auto temp = expected;
+    temp.set_mapped(mapped);
+    return std::make_pair(temp, _raw_data.compare_exchange_strong(
+                                    expected._word, temp._word,
+                                    memo::acq_rel));
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class F, class... Types>
+std::pair<typename quotient_slot<kb, vb, mq, H, m>::slot_type, bool>
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::non_atomic_update(
+    F f, Types&&... args)
+{
+    // NON-ATOMIC-UPDATES ARE INHERENTLY UNSAFE
+    auto temp   = load();
+    auto mapped = temp.get_mapped();
+    f(mapped, std::forward<Types>(args)...);
+    temp.set_mapped(mapped);
+    non_atomic_set(temp);
+    return std::make_pair(temp, true);
+}
+
+// *** positioned accesses *****************************************************
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper>
+typename quotient_slot<kb, vb, mq, H, m>::slot_type
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::load(
+    size_t pos, const Mapper& mapper) const
+{
+    return decode(_raw_data.load(memo::acquire), pos, mapper);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper>
+void quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::non_atomic_set(
+    const slot_type& goal, size_t pos, const Mapper& mapper)
+{
+    _raw_data.store(encode(goal, pos, mapper), std::memory_order_relaxed);
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper>
+bool quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::cas(
+    slot_type& expected, const slot_type& goal, size_t pos,
+    const Mapper& mapper)
+{
+    auto word = expected._word;
+    if (_raw_data.compare_exchange_strong(word, encode(goal, pos, mapper),
+                                          memo::acq_rel))
+        return true;
+    expected = decode(word, pos, mapper);
+    return false;
+}
+
+template <size_t kb, size_t vb, size_t mq, class H, bool m>
+template <class Mapper, class F, class... Types>
+std::pair<typename quotient_slot<kb, vb, mq, H, m>::slot_type, bool>
+quotient_slot<kb, vb, mq, H, m>::atomic_slot_type::non_atomic_update_at(
+    size_t pos, const Mapper& mapper, F f, Types&&... args)
+{
+    auto result = non_atomic_update(f, std::forward<Types>(args)...);
+    return std::make_pair(decode(result.first._word, pos, mapper), true);
+}
+} // namespace growt
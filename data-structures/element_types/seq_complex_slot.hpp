@@ -44,6 +44,8 @@ template <class Key, class Data> class seq_complex_slot
     static constexpr bool allows_updates               = false;
     static constexpr bool allows_referential_integrity = true;
     static constexpr bool needs_cleanup                = true;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
 
     class atomic_slot_type;
 
@@ -33,6 +33,8 @@ class seq_simple_slot
     static constexpr bool allows_updates               = true;
     static constexpr bool allows_referential_integrity = false;
     static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
 
     class atomic_slot_type;
 
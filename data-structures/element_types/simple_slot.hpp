@@ -46,6 +46,9 @@ class simple_slot
     static constexpr bool allows_updates               = true;
     static constexpr bool allows_referential_integrity = false;
     static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
+    static constexpr bool stores_hash                  = false;
 
     class atomic_slot_type;
 
@@ -316,9 +319,12 @@ simple_slot<K, D, m, dd>::atomic_slot_type::load() const
     // _mm_load_ps because the memory should be aligned
 
     // as128i() = (int128_t) _mm_loadu_ps((float *) &e);
-    auto temp = reinterpret_cast<int128_t>(
-        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_raw_data)));
-    return slot_type(temp);
+    auto temp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_raw_data));
+    // the slot has to be read exactly once, otherwise the compiler may split
+    // the load and read the key again (e.g. the expected value of a cas could
+    // be marked while the checked copy of the key was not)
+    asm volatile("" : "+x"(temp));
+    return slot_type(reinterpret_cast<int128_t>(temp));
 }
 
 template <class K, class D, bool m, K dd>
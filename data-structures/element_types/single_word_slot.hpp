@@ -43,6 +43,9 @@ class single_word_slot
     static constexpr bool allows_updates               = true;
     static constexpr bool allows_referential_integrity = false;
     static constexpr bool needs_cleanup                = false;
+    static constexpr bool needs_reclamation            = false;
+    static constexpr bool needs_position               = false;
+    static constexpr bool stores_hash                  = false;
 
     class atomic_slot_type;
 
@@ -0,0 +1,257 @@
+/*******************************************************************************
+ * data-structures/epoch_reclamation.hpp
+ *
+ * Epoch based reclamation for out-of-line elements (i.e. complex_slot).
+ * Table operations are executed inside an epoch_guard, which announces the
+ * current global epoch for the calling thread. Erased elements are retired
+ * into per thread limbo lists and are only destroyed once the global epoch
+ * advanced twice, i.e. once every thread that was inside an operation at the
+ * time of the deletion has left it.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utils/debug.hpp"
+namespace dtm = utils_tm::debug_tm;
+
+namespace growt
+{
+
+// Similar to the reclamation managers in utils_tm::reclamation_tm, but
+// there is one process wide manager, because slots can retire their pointers
+// without knowing the table or handle they belong to. Threads register
+// lazily on their first critical section; records of finished threads are
+// reused. Elements retired by finished threads are handed to a global orphan
+// list that is freed by whichever thread advances the epoch next.
+class epoch_manager
+{
+  public:
+    using deleter_type = void (*)(void*);
+
+    static void enter();
+    static void leave();
+    static void retire(void* ptr, deleter_type deleter);
+
+  private:
+    static constexpr size_t quiescent        = 0;
+    static constexpr size_t advance_interval = 64;
+
+    struct alignas(64) record_type
+    {
+        std::atomic_size_t epoch{quiescent};
+        std::atomic_bool   in_use{true};
+        record_type*       next = nullptr;
+    };
+
+    struct retired_type
+    {
+        void*        ptr;
+        deleter_type deleter;
+    };
+
+    struct limbo_type
+    {
+        size_t                    epoch = 0;
+        std::vector<retired_type> list;
+
+        void free_all()
+        {
+            for (auto& r : list) r.deleter(r.ptr);
+            list.clear();
+        }
+    };
+
+    struct global_data_type
+    {
+        std::atomic_size_t                          epoch{1};
+        std::atomic<record_type*>                   records{nullptr};
+        std::mutex                                  mutex;
+        std::vector<std::pair<size_t, retired_type>> orphans;
+    };
+
+    // leaked on purpose, tables (and their retired elements) can outlive
+    // static destruction
+    static global_data_type& global()
+    {
+        static global_data_type* g = new global_data_type();
+        return *g;
+    }
+
+    struct local_data_type
+    {
+        record_type* record  = nullptr;
+        size_t       nesting = 0;
+        size_t       retired = 0;
+        limbo_type   limbo[3];
+
+        ~local_data_type();
+    };
+
+    static thread_local local_data_type _local;
+
+    static record_type* acquire_record();
+    static void         try_advance(size_t epoch);
+};
+
+inline thread_local epoch_manager::local_data_type epoch_manager::_local;
+
+// RAII helper used by the tables (disabled for slots without out-of-line
+// elements). The announcement belongs to the creating thread, therefore, a
+// guard (and the iterator/reference holding it) cannot change threads, and
+// it blocks all reclamation while it exists.
+template <bool enabled>
+class epoch_guard
+{
+  public:
+    epoch_guard() : _owner(std::this_thread::get_id())
+    {
+        epoch_manager::enter();
+    }
+    ~epoch_guard()
+    {
+        dtm::if_debug_critical("epoch_guard released by another thread",
+                               _owner != std::this_thread::get_id());
+        epoch_manager::leave();
+    }
+
+    epoch_guard(const epoch_guard&)            = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+
+  private:
+    std::thread::id _owner;
+};
+
+template <>
+class epoch_guard<false>
+{
+};
+
+
+
+// IMPLEMENTATION **************************************************************
+
+inline void epoch_manager::enter()
+{
+    auto& l = _local;
+    if (l.nesting++) return;
+    if (!l.record) l.record = acquire_record();
+
+    auto& g = global();
+    auto  e = g.epoch.load(std::memory_order_acquire);
+    while (true)
+    {
+        // the announcement has to be visible before we read any slot
+        l.record->epoch.store(e, std::memory_order_seq_cst);
+        auto ne = g.epoch.load(std::memory_order_seq_cst);
+        if (ne == e) return;
+        e = ne;
+    }
+}
+
+inline void epoch_manager::leave()
+{
+    auto& l = _local;
+    if (--l.nesting) return;
+    l.record->epoch.store(quiescent, std::memory_order_release);
+}
+
+inline void epoch_manager::retire(void* ptr, deleter_type deleter)
+{
+    auto& l     = _local;
+    auto  e     = global().epoch.load(std::memory_order_acquire);
+    auto& limbo = l.limbo[e % 3];
+
+    // the bucket was last used in epoch e-3 (or earlier), since the global
+    // epoch reached e, no thread can still access these elements
+    if (limbo.epoch != e)
+    {
+        limbo.free_all();
+        limbo.epoch = e;
+    }
+    limbo.list.push_back(retired_type{ptr, deleter});
+
+    if (++l.retired % advance_interval == 0) try_advance(e);
+}
+
+inline epoch_manager::record_type* epoch_manager::acquire_record()
+{
+    auto& g = global();
+    for (auto r = g.records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        bool expected = false;
+        if (!r->in_use.load(std::memory_order_relaxed) &&
+            r->in_use.compare_exchange_strong(expected, true,
+                                              std::memory_order_acq_rel))
+            return r;
+    }
+
+    auto r  = new record_type();
+    r->next = g.records.load(std::memory_order_relaxed);
+    while (!g.records.compare_exchange_weak(r->next, r,
+                                            std::memory_order_acq_rel))
+    { /* retry */
+    }
+    return r;
+}
+
+inline void epoch_manager::try_advance(size_t epoch)
+{
+    auto& g = global();
+    for (auto r = g.records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        if (!r->in_use.load(std::memory_order_acquire)) continue;
+        auto re = r->epoch.load(std::memory_order_acquire);
+        if (re != quiescent && re != epoch) return;
+    }
+    g.epoch.compare_exchange_strong(epoch, epoch + 1,
+                                    std::memory_order_acq_rel);
+
+    auto current = g.epoch.load(std::memory_order_acquire);
+    for (auto& limbo : _local.limbo)
+        if (limbo.epoch + 2 <= current) limbo.free_all();
+
+    if (!g.mutex.try_lock()) return;
+    auto& orphans = g.orphans;
+    for (size_t i = 0; i < orphans.size();)
+    {
+        if (orphans[i].first + 2 <= current)
+        {
+            orphans[i].second.deleter(orphans[i].second.ptr);
+            orphans[i] = orphans.back();
+            orphans.pop_back();
+        }
+        else
+            ++i;
+    }
+    g.mutex.unlock();
+}
+
+inline epoch_manager::local_data_type::~local_data_type()
+{
+    if (!record) return;
+    record->epoch.store(quiescent, std::memory_order_release);
+    record->in_use.store(false, std::memory_order_release);
+    record = nullptr;
+
+    auto&                       g = global();
+    std::lock_guard<std::mutex> lock(g.mutex);
+    for (auto& limbo : this->limbo)
+    {
+        for (auto& r : limbo.list) g.orphans.emplace_back(limbo.epoch, r);
+        limbo.list.clear();
+    }
+}
+
+} // namespace growt
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * data-structures/hash_batch.hpp
+ *
+ * Optional extension of the hash functor concept. A hash functor can hash
+ * multiple integer keys at once by implementing
+ *     void hash_batch(const Key* keys, size_t n, size_t* hashes) const
+ * (it has to compute the same values as operator()). base_linear uses it
+ * automatically for batched operations and migrations.
+ * Two such hash functors (multiply-shift and CRC32C) are implemented here.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace growt
+{
+
+template <class HashFct, class Key>
+concept batch_hashable =
+    requires(const HashFct& hf, const Key* keys, size_t n, size_t* hashes) {
+        hf.hash_batch(keys, n, hashes);
+    };
+
+// hashes[i] = hf(keys[i]) for all i < n
+template <class HashFct, class Key>
+inline void
+hash_batch(const HashFct& hf, const Key* keys, size_t n, size_t* hashes)
+{
+    if constexpr (batch_hashable<HashFct, Key>)
+        hf.hash_batch(keys, n, hashes);
+    else
+        for (size_t i = 0; i < n; ++i) hashes[i] = hf(keys[i]);
+}
+
+
+
+// MULTIPLY-SHIFT **************************************************************
+// x = key * factor (mod 2^64), the high half (used by the linear mapping) is
+// a multiply-shift hash, it is folded into the low half for cyclic mappings.
+// AVX2 computes four 64 bit products from three 32x32 bit multiplications.
+class multiply_shift_hash
+{
+  public:
+    static constexpr size_t significant_digits = 64;
+
+    multiply_shift_hash(uint64_t seed = 0x9E3779B97F4A7C15ull)
+        : _factor(seed | 1)
+    {
+    }
+
+    inline uint64_t operator()(uint64_t k) const
+    {
+        uint64_t x = k * _factor;
+        return x ^ (x >> 32);
+    }
+
+    inline void hash_batch(const uint64_t* keys, size_t n, size_t* hashes) const
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i f_lo = _mm256_set1_epi64x(_factor & 0xffffffffull);
+        const __m256i f_hi = _mm256_set1_epi64x(_factor >> 32);
+        for (; i + 4 <= n; i += 4)
+        {
+            auto k = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(keys + i));
+            auto lo = _mm256_mul_epu32(k, f_lo);
+            auto c1 = _mm256_mul_epu32(_mm256_srli_epi64(k, 32), f_lo);
+            auto c2 = _mm256_mul_epu32(k, f_hi);
+            auto x  = _mm256_add_epi64(
+                lo, _mm256_slli_epi64(_mm256_add_epi64(c1, c2), 32));
+            x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(hashes + i), x);
+        }
+#endif
+        for (; i < n; ++i) hashes[i] = (*this)(keys[i]);
+    }
+
+  private:
+    uint64_t _factor;
+};
+
+
+
+// CRC32C **********************************************************************
+// two CRC32C instructions form one 64 bit hash (the second one hashes the
+// rotated key, otherwise both halves would only differ by a constant). The
+// instruction has a latency of 3 cycles but a throughput of 1, therefore,
+// the batched version interleaves four keys (eight independent CRCs).
+#if defined(__SSE4_2__)
+class crc32c_hash
+{
+  public:
+    static constexpr size_t significant_digits = 64;
+
+    crc32c_hash(uint64_t seed = 12039890238109ull)
+        : _seed_hi(uint32_t(seed >> 32)), _seed_lo(uint32_t(seed))
+    {
+    }
+
+    inline uint64_t operator()(uint64_t k) const
+    {
+        return (uint64_t(_mm_crc32_u64(_seed_hi, k)) << 32) |
+               _mm_crc32_u64(_seed_lo, rotate(k));
+    }
+
+    inline void hash_batch(const uint64_t* keys, size_t n, size_t* hashes) const
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            uint64_t h0 = _mm_crc32_u64(_seed_hi, keys[i]);
+            uint64_t h1 = _mm_crc32_u64(_seed_hi, keys[i + 1]);
+            uint64_t h2 = _mm_crc32_u64(_seed_hi, keys[i + 2]);
+            uint64_t h3 = _mm_crc32_u64(_seed_hi, keys[i + 3]);
+            uint64_t l0 = _mm_crc32_u64(_seed_lo, rotate(keys[i]));
+            uint64_t l1 = _mm_crc32_u64(_seed_lo, rotate(keys[i + 1]));
+            uint64_t l2 = _mm_crc32_u64(_seed_lo, rotate(keys[i + 2]));
+            uint64_t l3 = _mm_crc32_u64(_seed_lo, rotate(keys[i + 3]));
+            hashes[i]     = (h0 << 32) | l0;
+            hashes[i + 1] = (h1 << 32) | l1;
+            hashes[i + 2] = (h2 << 32) | l2;
+            hashes[i + 3] = (h3 << 32) | l3;
+        }
+        for (; i < n; ++i) hashes[i] = (*this)(keys[i]);
+    }
+
+  private:
+    static inline uint64_t rotate(uint64_t k) { return (k >> 32) | (k << 32); }
+
+    uint32_t _seed_hi;
+    uint32_t _seed_lo;
+};
+#endif
+
+} // namespace growt
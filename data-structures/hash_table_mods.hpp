@@ -4,14 +4,23 @@
 
 enum class hmod : size_t
 {
-    neutral       = 0,
-    growable      = 1,
-    deletion      = 2,
-    ref_integrity = 4,
-    sync          = 8,
-    pool          = 16,
-    circular_map  = 32,
-    circular_prob = 64
+    neutral         = 0,
+    growable        = 1,
+    deletion        = 2,
+    ref_integrity   = 4,
+    sync            = 8,
+    pool            = 16,
+    circular_map    = 32,
+    circular_prob   = 64,
+    tag_probing     = 128,
+    bounded_probing = 256,
+    inplace_updates = 512,
+    lookup_filter   = 1024,
+    stored_hash     = 2048,
+    stats           = 4096,
+    incremental     = 8192,
+    shared_pool     = 16384,
+    nohelp_finds    = 32768
 };
 
 template <hmod... Mods> class mod_aggregator
@@ -0,0 +1,184 @@
+/*******************************************************************************
+ * data-structures/migration_executor.hpp
+ *
+ * Process-wide pool of migration threads, shared by all tables (see
+ * wstrat_shared.hpp). The number of threads is fixed: by default one thread
+ * per cpu of the process affinity mask, each pinned to its cpu. The
+ * threads are started once the first migration is requested (creating
+ * handles or tables never spawns threads). Tables publish a job while they
+ * migrate, idle threads are distributed round robin over the published
+ * jobs, therefore, concurrent migrations of different tables share the
+ * same threads.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "data-structures/migration_trace.hpp"
+
+namespace growt
+{
+
+class migration_executor
+{
+  public:
+    // one job per table, it is published while the table migrates and
+    // executed by any number of threads at once
+    class job_type
+    {
+      public:
+        using function_type = void (*)(void* context, int epoch);
+
+        job_type() = default;
+        job_type(const job_type&)            = delete;
+        job_type& operator=(const job_type&) = delete;
+
+        // false if the job was never requested (no need to withdraw it)
+        bool requested() const { return _function != nullptr; }
+
+      private:
+        friend migration_executor;
+
+        // all fields are only accessed under the executor's mutex
+        function_type _function = nullptr;
+        void*         _context  = nullptr;
+        int           _epoch    = 0; // the requested migration
+        size_t        _active   = 0; // threads executing the job
+        bool          _queued   = false;
+    };
+
+    // the executor is created on first use and never destroyed (tables can
+    // outlive any static object), its threads are detached
+    static migration_executor& instance()
+    {
+        static migration_executor* executor = new migration_executor(
+            _configured_threads.load(std::memory_order_acquire));
+        return *executor;
+    }
+
+    // changes the number of threads, only has an effect before the first
+    // migration is requested (0 = one thread per available cpu)
+    static void configure(size_t threads)
+    {
+        _configured_threads.store(threads, std::memory_order_release);
+    }
+
+    size_t num_threads() const { return _threads; }
+
+    // publishes the job for the migration of epoch, threads will execute
+    // function(context, epoch) (repeated requests for the same migration
+    // are ignored)
+    void request(job_type& job, job_type::function_type function,
+                 void* context, int epoch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (job._queued && job._epoch >= epoch) return;
+            job._function = function;
+            job._context  = context;
+            job._epoch    = epoch;
+            if (!job._queued)
+            {
+                job._queued = true;
+                _jobs.push_back(&job);
+            }
+        }
+        _wake.notify_all();
+    }
+
+    // removes the job, returns once no thread executes it anymore
+    void withdraw(job_type& job)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        dequeue(job);
+        _idle.wait(lock, [&job] { return job._active == 0; });
+    }
+
+  private:
+    migration_executor(size_t threads) : _threads(0), _next(0)
+    {
+        auto cpus = available_cpus();
+        _threads  = (threads) ? threads : cpus.size();
+
+        // fewer threads than cpus are spread evenly over the cpus, i.e.,
+        // over all nodes, since cpu ids are usually grouped by node
+        for (size_t i = 0; i < _threads; ++i)
+        {
+            auto cpu = cpus[i * cpus.size() / _threads];
+            std::thread(&migration_executor::thread_loop, this, cpu).detach();
+        }
+    }
+
+    static std::vector<int> available_cpus()
+    {
+        std::vector<int> cpus;
+        cpu_set_t        set;
+        CPU_ZERO(&set);
+        if (!sched_getaffinity(0, sizeof(cpu_set_t), &set))
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+                if (CPU_ISSET(i, &set)) cpus.push_back(i);
+        if (cpus.empty()) cpus.push_back(0);
+        return cpus;
+    }
+
+    void dequeue(job_type& job)
+    {
+        if (!job._queued) return;
+        job._queued = false;
+        _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job));
+    }
+
+    // wait for a job -> execute it -> remove it, unless it was requested
+    // again in the meantime -> repeat
+    void thread_loop(int cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+        trace_thread_name("growt executor");
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _wake.wait(lock, [this] { return !_jobs.empty(); });
+            auto job   = _jobs[_next++ % _jobs.size()];
+            auto epoch = job->_epoch;
+            ++job->_active;
+
+            lock.unlock();
+            job->_function(job->_context, epoch);
+            lock.lock();
+
+            // the function returns once all blocks are taken
+            if (job->_epoch == epoch) dequeue(*job);
+            if (!--job->_active) _idle.notify_all();
+        }
+    }
+
+    static inline std::atomic_size_t _configured_threads{0};
+
+    size_t                  _threads;
+    std::mutex              _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    std::vector<job_type*>  _jobs;
+    size_t                  _next; // round robin over the jobs
+};
+
+} // namespace growt
@@ -0,0 +1,256 @@
+/*******************************************************************************
+ * data-structures/migration_scheduler.hpp
+ *
+ * Distributes the blocks of a blockwise migration (or purge) among the
+ * helping threads. Each helper takes a chunk of consecutive blocks from a
+ * shared pool, the chunk size shrinks with the remaining work (guided
+ * self-scheduling: remaining / (2 * threads)). Thus, large tables need few
+ * accesses to the shared counter, while the last chunks are single blocks.
+ * Helpers publish their current chunk and take one block at a time from its
+ * front, once the pool is empty, idle helpers steal the back half of another
+ * helper's chunk. Tables whose memory is split by node have one pool per
+ * node, helpers take chunks of their own node first.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "data-structures/migration_trace.hpp"
+#include "data-structures/numa_location.hpp"
+
+namespace growt
+{
+
+class migration_scheduler
+{
+  public:
+    // chunks consist of whole blocks, a block is migrated by one call of
+    // migrate (purge relies on blocks being aligned to block_size)
+    static constexpr size_t block_size = 1024;
+
+    class helper_type;
+
+    migration_scheduler(size_t slots, size_t partitions = 1)
+        : _slots(slots), _num_blocks((slots + block_size - 1) / block_size),
+          _num_pools(std::max<size_t>(partitions, 1)),
+          _pool_threads(std::max<size_t>(num_threads() / _num_pools, 1)),
+          _pools(std::make_unique<pool_type[]>(_num_pools)),
+          _num_ranges(std::clamp<size_t>(
+              std::min(num_threads(), _num_blocks), 1, 1024)),
+          _ranges(std::make_unique<range_type[]>(_num_ranges)), _next_range(0)
+    {
+        // pools approximately match the node parts of the allocation
+        size_t part = (_num_blocks + _num_pools - 1) / _num_pools;
+        for (size_t i = 0; i < _num_pools; ++i)
+        {
+            _pools[i].begin = std::min(i * part, _num_blocks);
+            _pools[i].end   = std::min(_pools[i].begin + part, _num_blocks);
+            _pools[i].next.store(_pools[i].begin, std::memory_order_relaxed);
+        }
+    }
+    migration_scheduler(const migration_scheduler&)            = delete;
+    migration_scheduler& operator=(const migration_scheduler&) = delete;
+
+    // true once a block has been handed out
+    bool started() const
+    {
+        for (size_t i = 0; i < _num_pools; ++i)
+            if (_pools[i].next.load(std::memory_order_acquire) !=
+                _pools[i].begin)
+                return true;
+        return false;
+    }
+
+    // hand out all blocks again (only while there are no helpers)
+    void reset()
+    {
+        for (size_t i = 0; i < _num_pools; ++i)
+            _pools[i].next.store(_pools[i].begin, std::memory_order_relaxed);
+        for (size_t i = 0; i < _num_ranges; ++i)
+            _ranges[i].value.store(0, std::memory_order_relaxed);
+        _next_range.store(0, std::memory_order_release);
+    }
+
+  private:
+    struct alignas(64) pool_type
+    {
+        std::atomic_size_t next{0};
+        size_t             begin = 0;
+        size_t             end   = 0;
+    };
+
+    // the remaining blocks [begin, end) of one helper's chunk, packed into
+    // one word, such that the owner (begin) and thieves (end) can use CAS
+    struct alignas(64) range_type
+    {
+        std::atomic_uint64_t value{0};
+    };
+
+    static constexpr uint64_t pack(size_t begin, size_t end)
+    {
+        return (uint64_t(end) << 32) + uint64_t(begin);
+    }
+    static constexpr size_t begin_of(uint64_t value)
+    {
+        return size_t(value & 0xffffffffull);
+    }
+    static constexpr size_t end_of(uint64_t value)
+    {
+        return size_t(value >> 32);
+    }
+
+    static size_t num_threads()
+    {
+        static const size_t threads =
+            std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        return threads;
+    }
+
+    // a chunk [begin, end) of the pool, its size is guided by the blocks that
+    // are still left in the pool
+    bool take_chunk(pool_type& pool, uint64_t& chunk)
+    {
+        auto next = pool.next.load(std::memory_order_relaxed);
+        if (next >= pool.end) return false;
+        auto size  = std::max<size_t>((pool.end - next) / (2 * _pool_threads),
+                                     1);
+        auto begin = pool.next.fetch_add(size, std::memory_order_acq_rel);
+        if (begin >= pool.end) return false;
+        chunk = pack(begin, std::min(begin + size, pool.end));
+        return true;
+    }
+
+    // the victim keeps the front half, the thief gets the back half
+    static bool steal_chunk(range_type& victim, uint64_t& chunk)
+    {
+        auto curr = victim.value.load(std::memory_order_acquire);
+        while (true)
+        {
+            auto begin = begin_of(curr);
+            auto end   = end_of(curr);
+            if (end < begin + 2) return false;
+            auto mid = begin + (end - begin) / 2;
+            if (victim.value.compare_exchange_weak(curr, pack(begin, mid),
+                                                   std::memory_order_acq_rel))
+            {
+                chunk = pack(mid, end);
+                return true;
+            }
+        }
+    }
+
+    size_t                        _slots;
+    size_t                        _num_blocks;
+    size_t                        _num_pools;
+    size_t                        _pool_threads;
+    std::unique_ptr<pool_type[]>  _pools;
+    size_t                        _num_ranges;
+    std::unique_ptr<range_type[]> _ranges;
+    std::atomic_size_t            _next_range;
+};
+
+
+
+// HELPER LOCAL PART ***********************************************************
+// one helper per thread and migration, it is neither copied nor moved
+// (thieves may still access its range)
+class migration_scheduler::helper_type
+{
+  public:
+    helper_type(migration_scheduler& scheduler)
+        : _scheduler(scheduler), _range(&_unpublished),
+          _home(this_cpu_location().node % scheduler._num_pools),
+          _index(scheduler._next_range.fetch_add(1, std::memory_order_acq_rel))
+    {
+        // helpers beyond the number of range slots (one per thread, at most
+        // one per block) cannot be stolen from
+        if (_index < scheduler._num_ranges) _range = &scheduler._ranges[_index];
+    }
+    helper_type(const helper_type&)            = delete;
+    helper_type& operator=(const helper_type&) = delete;
+
+    // the next block [s,e) in slots, false once all blocks are taken
+    bool next(size_t& s, size_t& e)
+    {
+        size_t block;
+        while (!take_block(block))
+            if (!refill()) return false;
+        s = block * block_size;
+        e = std::min(s + block_size, _scheduler._slots);
+        return true;
+    }
+
+  private:
+    bool take_block(size_t& block)
+    {
+        auto curr = _range->value.load(std::memory_order_acquire);
+        while (true)
+        {
+            auto begin = begin_of(curr);
+            auto end   = end_of(curr);
+            if (begin >= end) return false;
+            if (_range->value.compare_exchange_weak(
+                    curr, pack(begin + 1, end), std::memory_order_acq_rel))
+            {
+                block = begin;
+                return true;
+            }
+        }
+    }
+
+    // the own range is empty (thieves leave it alone), therefore, the new
+    // chunk can be stored without CAS
+    bool refill()
+    {
+        uint64_t chunk;
+        auto&    sched = _scheduler;
+        for (size_t i = 0; i < sched._num_pools; ++i)
+        {
+            if (sched.take_chunk(sched._pools[(_home + i) % sched._num_pools],
+                                 chunk))
+            {
+                _range->value.store(chunk, std::memory_order_release);
+                trace_instant("take_chunk", "blocks",
+                              end_of(chunk) - begin_of(chunk));
+                return true;
+            }
+        }
+
+        // thieves start at different victims
+        auto used = std::min(sched._next_range.load(std::memory_order_acquire),
+                             sched._num_ranges);
+        for (size_t i = 1; i <= used; ++i)
+        {
+            auto& victim = sched._ranges[(_index + i) % used];
+            if (&victim == _range) continue;
+            if (steal_chunk(victim, chunk))
+            {
+                _range->value.store(chunk, std::memory_order_release);
+                trace_instant("steal_chunk", "blocks",
+                              end_of(chunk) - begin_of(chunk));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    migration_scheduler& _scheduler;
+    range_type*          _range;
+    size_t               _home;
+    size_t               _index;
+    range_type           _unpublished;
+};
+
+} // namespace growt
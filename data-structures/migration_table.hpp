@@ -21,12 +21,16 @@
 #include <atomic>
 #include <iostream>
 #include <memory>
+#include <span>
 #include <sstream>
 #include <string>
+#include <vector>
 
 
+#include "data-structures/element_counter.hpp"
 #include "data-structures/migration_table_iterator.hpp"
 #include "data-structures/returnelement.hpp"
+#include "data-structures/table_stats.hpp"
 #include "example/update_fcts.hpp"
 
 namespace growt
@@ -43,11 +47,13 @@ template <class HashTable,
           template <class>
           class WorkerStrat,
           template <class>
-          class ExclusionStrat>
+          class ExclusionStrat,
+          bool NoHelpFinds = false>
 class migration_table
 {
   private:
-    using this_type = migration_table<HashTable, WorkerStrat, ExclusionStrat>;
+    using this_type =
+        migration_table<HashTable, WorkerStrat, ExclusionStrat, NoHelpFinds>;
 
   protected:
     using migration_table_data_type = migration_table_data<this_type>;
@@ -66,11 +72,20 @@ class migration_table
     static constexpr bool allows_updates = base_table_type::allows_updates;
     static constexpr bool allows_referential_integrity =
         base_table_type::allows_referential_integrity;
+    // find (and find_batch) neither help with nor wait for migrations
+    // (see migration_table_handle::find_nohelp)
+    static constexpr bool nohelp_finds = NoHelpFinds;
 
     using handle_type = migration_table_handle<migration_table_data_type>;
     friend handle_type;
 
-    migration_table(size_t size) : _mt_data(new migration_table_data_type(size))
+    using batch_element_type = typename base_table_type::batch_element_type;
+
+    // min_fill_factor is the low-water mark, if the fraction of live elements
+    // falls below it, the table is migrated into a smaller table (0 disables
+    // shrinking)
+    migration_table(size_t size, double min_fill_factor = 0.)
+        : _mt_data(new migration_table_data_type(size, min_fill_factor))
     {
     }
 
@@ -84,6 +99,30 @@ class migration_table
 
     handle_type get_handle() { return handle_type(*_mt_data); }
 
+    // sum of the operation counters of all handles (see table_stats.hpp),
+    // handles can continue to operate concurrently
+    table_stats stats() const { return _mt_data->stats(); }
+
+    // number of elements (see element_counter.hpp), size_exact sums the
+    // counters of all handles, size_approx reads one shared counter
+    size_t size_exact() const { return _mt_data->size_exact(); }
+    size_t size_approx() const { return _mt_data->size_approx(); }
+
+    // parallel bulk construction, the table is sized to hold all elements and
+    // filled without atomic operations (see base_linear::bulk_insert_unsafe)
+    static migration_table
+    build_from(std::span<const batch_element_type> elements,
+               size_t                              num_threads,
+               double                              min_fill_factor = 0.)
+    {
+        migration_table table(elements.size(), min_fill_factor);
+        {
+            auto handle = table.get_handle();
+            handle.bulk_insert_unsafe(elements, num_threads);
+        }
+        return table;
+    }
+
     static std::string name()
     {
         std::stringstream name;
@@ -119,10 +158,11 @@ class migration_table_data
 
 
 
-    migration_table_data(size_type size_)
+    migration_table_data(size_type size_, double min_fill_factor = 0.)
         : _global_exclusion(std::max(size_, size_type(1) << 15)),
           _global_worker(), // handle_ptr(64),
-          _elements(0), _dummies(0), _grow_count(0)
+          _min_fill_factor(std::min(min_fill_factor, _max_min_fill_factor)),
+          _reserved(0), _element_count(), _grow_count(0)
     {
     }
 
@@ -133,20 +173,34 @@ class migration_table_data
     migration_table_data& operator=(migration_table_data&&) = delete;
     ~migration_table_data()                                 = default;
 
-    size_type element_count_approx()
-    {
-        return _elements.load() - _dummies.load();
-    }
+    size_type element_count_approx() const { return size_approx(); }
+    size_type size_approx() const { return _element_count.size_approx(); }
+    size_type size_exact() const { return _element_count.size_exact(); }
+
+    table_stats stats() const { return _stats.sum(); }
 
   protected:
     // DATA+FUNCTIONS FOR MIGRATION STRATEGIES
     mutable typename exclusion_strat::global_data_type _global_exclusion;
     mutable typename worker_strat::global_data_type    _global_worker;
 
-    // APPROXIMATE COUNTS
-    alignas(64) std::atomic_int _elements;
-    alignas(64) std::atomic_int _dummies;
+    // LOW-WATER MARK FOR SHRINKING (HYSTERESIS: a shrunk table is filled by
+    // more than half of mapper_type::shrink_target_fill, thus the mark is
+    // clamped below that)
+    static constexpr double _max_min_fill_factor = 0.1;
+    const double            _min_fill_factor;
+
+    // MINIMUM CAPACITY REQUESTED THROUGH reserve(n) (migrations never produce
+    // smaller tables)
+    std::atomic_size_t _reserved;
+
+    // ELEMENT COUNTS (EXACT PER HANDLE, COMBINED INTO AN APPROXIMATE
+    // OCCUPANCY OF THE CURRENT TABLE)
+    element_counter             _element_count;
     alignas(64) std::atomic_int _grow_count;
+
+    // OPERATION STATISTICS OF ALL HANDLES
+    stats_registry _stats;
 };
 
 
@@ -169,6 +223,7 @@ class migration_table_handle
     using worker_strat    = typename migration_table_data::worker_strat;
     using exclusion_strat = typename migration_table_data::exclusion_strat;
     friend migration_table_data;
+    friend parent_type;
 
   public:
     using hash_ptr_reference = typename exclusion_strat::hash_ptr_reference;
@@ -194,6 +249,7 @@ class migration_table_handle
     using mapped_reference = typename iterator::mapped_reference;
     using const_mapped_reference = typename const_iterator::mapped_reference;
     using insert_return_type     = std::pair<iterator, bool>;
+    using batch_element_type     = typename base_table_type::batch_element_type;
 
     using local_iterator       = void;
     using const_local_iterator = void;
@@ -201,9 +257,14 @@ class migration_table_handle
 
   protected:
     using base_table_iterator = typename base_table_type::iterator;
+    using base_mapper_type    = typename base_table_type::mapper_type;
     using base_table_insert_return_type =
         typename base_table_type::insert_return_intern;
     using base_table_citerator = typename base_table_type::const_iterator;
+    using reclamation_guard_type =
+        typename base_table_type::reclamation_guard_type;
+    using handle_stats_type =
+        handle_stats<base_table_type::config_type::collect_stats>;
 
     friend iterator;
     friend reference;
@@ -240,6 +301,9 @@ class migration_table_handle
     size_type          erase(const key_type& k);
     iterator           find(const key_type& k);
     const_iterator     find(const key_type& k) const;
+    // finds that neither help with nor wait for a pending migration, they
+    // read the table that currently holds k (not with hmod::sync)
+    iterator           find_nohelp(const key_type& k);
 
     insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
     {
@@ -292,7 +356,25 @@ class migration_table_handle
 
     size_type erase_if(const key_type& k, const mapped_type& d);
 
+    // BATCHED OPERATIONS (f(i, it) is called with the result for keys[i])
+    template <class F>
+    size_type find_batch(std::span<const key_type> keys, F f);
+    size_type insert_batch(std::span<const batch_element_type> elements);
+    template <class F, class... Types>
+    size_type
+    insert_or_update_batch(std::span<const batch_element_type> elements,
+                           F                                   f,
+                           Types&&... args);
+
     size_type element_count_approx() { return _mt_data.element_count_approx(); }
+    size_type size_approx() const { return _mt_data.size_approx(); }
+    size_type size_exact() const { return _mt_data.size_exact(); }
+    table_stats stats() const { return _mt_data.stats(); }
+
+    // grows the table (in one migration) such that n elements fit without
+    // triggering further growing steps, later migrations do not shrink the
+    // table below this capacity
+    void reserve(size_type n);
 
   protected:
     // DATA+FUNCTIONS FOR MIGRATION STRATEGIES
@@ -300,6 +382,7 @@ class migration_table_handle
     size_type                                         _handle_id;
     mutable typename worker_strat::local_data_type    _local_worker;
     mutable typename exclusion_strat::local_data_type _local_exclusion;
+    mutable handle_stats_type                         _stats;
 
 
     inline insert_return_type insert_intern(slot_type& slot);
@@ -312,10 +395,25 @@ class migration_table_handle
     inline insert_return_type
     insert_or_update_unsafe_intern(slot_type& slot, F f, Types&&... args);
 
-    inline void grow(int version) const { _local_exclusion.grow(version); }
+    // only used by migration_table::build_from (no concurrent operations)
+    inline size_type
+    bulk_insert_unsafe(std::span<const batch_element_type> elements,
+                       size_type                           num_threads);
+
+    template <class BaseOp, class SingleOp>
+    inline size_type batch_intern(std::span<const batch_element_type> elements,
+                                  BaseOp                              bop,
+                                  SingleOp                            sop);
+
+    inline void grow(int version) const
+    {
+        auto mig_stats = _stats.count_migration(&stats_counters::grows);
+        _local_exclusion.grow(version);
+    }
 
     inline void help_grow(int version) const
     {
+        auto mig_stats = _stats.count_migration(&stats_counters::help_grows);
         _local_exclusion.help_grow(version);
     }
     inline void rls_table() const { _local_exclusion.rls_table(); }
@@ -330,6 +428,8 @@ class migration_table_handle
         typename std::result_of<Functor(hash_ptr_reference, Types&&...)>::type
         execute(Functor f, Types&&... param)
     {
+        [[maybe_unused]] reclamation_guard_type guard;
+        migration_step();
         hash_ptr_reference temp = _local_exclusion.get_table();
         auto               result =
             std::forward<Functor>(f)(temp, std::forward<Types>(param)...);
@@ -342,6 +442,8 @@ class migration_table_handle
         typename std::result_of<Functor(hash_ptr_reference, Types&&...)>::type
         cexecute(Functor f, Types&&... param) const
     {
+        [[maybe_unused]] reclamation_guard_type guard;
+        migration_step();
         hash_ptr_reference temp = _local_exclusion.get_table();
         auto               result =
             std::forward<Functor>(f)(temp, std::forward<Types>(param)...);
@@ -349,13 +451,87 @@ class migration_table_handle
         return result;
     }
 
+    // operations on one key, during incremental migrations they are routed
+    // to the table that holds the key (see estrat_incremental.hpp)
+    template <typename Functor, typename... Types>
+    inline
+        typename std::result_of<Functor(hash_ptr_reference, Types&&...)>::type
+        execute_at(const key_type& k, Functor f, Types&&... param)
+    {
+        [[maybe_unused]] reclamation_guard_type guard;
+        migration_step();
+        hash_ptr_reference temp = _local_exclusion.get_table();
+        if constexpr (exclusion_strat::incremental)
+            temp = _local_exclusion.route(temp, k);
+        auto result =
+            std::forward<Functor>(f)(temp, std::forward<Types>(param)...);
+        rls_table();
+        return result;
+    }
+
+    template <typename Functor, typename... Types>
+    inline
+        typename std::result_of<Functor(hash_ptr_reference, Types&&...)>::type
+        cexecute_at(const key_type& k, Functor f, Types&&... param) const
+    {
+        [[maybe_unused]] reclamation_guard_type guard;
+        migration_step();
+        hash_ptr_reference temp = _local_exclusion.get_table();
+        if constexpr (exclusion_strat::incremental)
+            temp = _local_exclusion.route(temp, k);
+        auto result =
+            std::forward<Functor>(f)(temp, std::forward<Types>(param)...);
+        rls_table();
+        return result;
+    }
+
+    // lookups that neither help nor wait (see find_nohelp)
+    template <typename Functor, typename... Types>
+    inline
+        typename std::result_of<Functor(hash_ptr_reference, Types&&...)>::type
+        execute_nohelp(const key_type& k, Functor f, Types&&... param) const
+    {
+        [[maybe_unused]] reclamation_guard_type guard;
+        hash_ptr_reference temp = _local_exclusion.read_table(k);
+        auto               result =
+            std::forward<Functor>(f)(temp, std::forward<Types>(param)...);
+        rls_table();
+        return result;
+    }
+
+    // incremental migrations are advanced by a few blocks per operation,
+    // each step is counted like a help_grow call
+    inline void migration_step() const
+    {
+        if constexpr (exclusion_strat::incremental)
+        {
+            if (!_local_exclusion.migration_pending()) return;
+            auto mig_stats =
+                _stats.count_migration(&stats_counters::help_grows);
+            _local_exclusion.step();
+        }
+    }
+
+    // whole-table operations (iteration, scans) need all elements in one
+    // table, a pending incremental migration is completed first
+    inline void complete_migration() const
+    {
+        if constexpr (exclusion_strat::incremental)
+        {
+            if (!_local_exclusion.migration_pending()) return;
+            auto mig_stats =
+                _stats.count_migration(&stats_counters::help_grows);
+            _local_exclusion.complete_migration();
+        }
+    }
+
     inline iterator
     make_iterator(const base_table_iterator& bit, size_t version)
     {
         return iterator(bit, version, *this);
     }
-    inline iterator
-    make_citerator(const base_table_citerator& bcit, size_t version)
+    inline const_iterator
+    make_citerator(const base_table_citerator& bcit, size_t version) const
     {
         return const_iterator(bcit, version, *this);
     }
@@ -370,61 +546,23 @@ class migration_table_handle
     {
         return base_table_iterator(slot_config::get_empty(), nullptr, nullptr);
     }
-    inline base_table_iterator bcend()
+    inline base_table_citerator bcend() const
     {
         return base_table_citerator(slot_config::get_empty(), nullptr, nullptr);
     }
 
     static constexpr double _max_fill_factor = 0.666;
 
-    // LOCAL COUNTERS FOR SIZE ESTIMATION WITH SOME PADDING FOR
-    // REDUCING CACHE EFFECTS
+    // LOCAL COUNTERS FOR SIZE ESTIMATION (PADDED, REGISTERED AT THE GLOBAL
+    // element_counter)
   public:
-    void update_numbers();
+    void update_numbers(bool forward_leaf = false);
 
   protected:
     void inc_inserted();
     void inc_deleted();
 
-    class alignas(64) local_count
-    {
-      public:
-        int _updates;
-        int _inserted;
-        int _deleted;
-        local_count() : _updates(0), _inserted(0), _deleted(0) {}
-
-        local_count(local_count&& rhs)
-            : _updates(rhs._updates), _inserted(rhs._inserted),
-              _deleted(rhs._deleted)
-        {
-            rhs._updates  = 0;
-            rhs._inserted = 0;
-            rhs._deleted  = 0;
-        }
-
-        local_count& operator=(local_count&& rhs)
-        {
-            _updates      = rhs._updates;
-            _inserted     = rhs._inserted;
-            _deleted      = rhs._deleted;
-            rhs._updates  = 0;
-            rhs._inserted = 0;
-            rhs._deleted  = 0;
-            return *this;
-        }
-
-        void set(int upd, int in, int del)
-        {
-            _updates  = upd;
-            _inserted = in;
-            _deleted  = del;
-        }
-
-        local_count(const local_count&) = delete;
-        local_count& operator=(const local_count&) = delete;
-    };
-    local_count _counts;
+    element_counter::handle_type _counts;
 
   public:
     using range_iterator       = typename base_table_type::range_iterator;
@@ -433,6 +571,7 @@ class migration_table_handle
     /* size has to divide capacity */
     range_iterator range(size_t rstart, size_t rend)
     {
+        complete_migration();
         range_iterator result = execute([rstart, rend](hash_ptr_reference tab) {
             return tab->range(rstart, rend);
         });
@@ -440,6 +579,7 @@ class migration_table_handle
     }
     const_range_iterator crange(size_t rstart, size_t rend)
     {
+        complete_migration();
         const_range_iterator result =
             cexecute([rstart, rend](hash_ptr_reference tab) {
                 return tab->crange(rstart, rend);
@@ -454,6 +594,27 @@ class migration_table_handle
             cexecute([](hash_ptr_reference tab) { return tab->capacity(); });
         return cap;
     }
+    // lookup filter of the current table (see hmod::lookup_filter)
+    size_t filter_memory() const
+    {
+        return cexecute(
+            [](hash_ptr_reference tab) { return tab->filter_memory(); });
+    }
+    double filter_false_positive_rate() const
+    {
+        return cexecute([](hash_ptr_reference tab) {
+            return tab->filter_false_positive_rate();
+        });
+    }
+    // scan of the current table (see table_health.hpp), it is protected
+    // from migrations during the scan, updates should be paused
+    table_health health(size_t num_threads = 1, size_t block_size = 4096) const
+    {
+        complete_migration();
+        return cexecute([num_threads, block_size](hash_ptr_reference tab) {
+            return tab->health(num_threads, block_size);
+        });
+    }
 };
 
 
@@ -468,7 +629,8 @@ template <class migration_table_data>
 migration_table_handle<migration_table_data>::migration_table_handle(
     migration_table_data& data)
     : _mt_data(data), _local_worker(data),
-      _local_exclusion(data, _local_worker), _counts()
+      _local_exclusion(data, _local_worker), _stats(data._stats),
+      _counts(data._element_count)
 {
     // handle_id = _mt_data.handle_ptr.push_back(this);
 
@@ -481,7 +643,9 @@ template <class migration_table_data>
 migration_table_handle<migration_table_data>::migration_table_handle(
     parent_type& parent)
     : _mt_data(*(parent._mt_data)), _local_worker(*(parent._mt_data)),
-      _local_exclusion(*(parent._mt_data), _local_worker), _counts()
+      _local_exclusion(*(parent._mt_data), _local_worker),
+      _stats(parent._mt_data->_stats),
+      _counts(parent._mt_data->_element_count)
 {
     // handle_id = _mt_data.handle_ptr.push_back(this);
 
@@ -498,9 +662,8 @@ migration_table_handle<migration_table_data>::migration_table_handle(
     : _mt_data(source._mt_data), _handle_id(source._handle_id),
       _local_worker(std::move(source._local_worker)),
       _local_exclusion(std::move(source._local_exclusion)),
-      _counts(std::move(source._counts))
+      _stats(std::move(source._stats)), _counts(std::move(source._counts))
 {
-    source._counts = local_count();
     //_mt_data.handle_ptr.update(_handle_id, this);
     // source._handle_id = std::numeric_limits<size_t>::max();
 }
@@ -528,10 +691,8 @@ migration_table_handle<migration_table_data>::~migration_table_handle()
     //     _mt_data.handle_ptr.remove(_handle_id);
     // }
 
-    // if (_counts._version >= 0)
-    {
-        update_numbers();
-    }
+    // the remaining updates become visible in size_approx()
+    update_numbers(true);
 
     _local_worker.deinit();
     _local_exclusion.deinit();
@@ -551,6 +712,7 @@ inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::insert(const key_type&    k,
                                                      const mapped_type& d)
 {
+    auto op_stats = _stats.count_op(&stats_counters::inserts);
     auto slot   = slot_type(k, d);
     auto result = insert_intern(slot);
     if constexpr (slot_config::needs_cleanup)
@@ -564,6 +726,7 @@ template <class migration_table_data>
 inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::insert(const value_type& e)
 {
+    auto op_stats = _stats.count_op(&stats_counters::inserts);
     auto slot   = slot_type(e);
     auto result = insert_intern(slot);
     if constexpr (slot_config::needs_cleanup)
@@ -578,6 +741,7 @@ template <class... Args>
 inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::emplace(Args&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::inserts);
     auto slot   = slot_type(std::forward<Args>(args)...);
     auto result = insert_intern(slot);
     if constexpr (slot_config::needs_cleanup)
@@ -594,7 +758,8 @@ migration_table_handle<migration_table_data>::insert_intern(slot_type& slot)
     int                           v = -1;
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        slot.get_key_ref(),
         [](hash_ptr_reference t,
            slot_type&         slot)                              //
         -> std::pair<int, base_table_insert_return_type> //
@@ -636,11 +801,13 @@ migration_table_handle<migration_table_data>::update(const key_type& k,
                                                      F               f,
                                                      Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::updates);
     int                           v = -1;
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        k,
         [](hash_ptr_reference t, const key_type& k, F f,
            Types&&... args) -> std::pair<int, base_table_insert_return_type> {
             std::pair<int, base_table_insert_return_type> result =
@@ -679,11 +846,13 @@ inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::update_with_backoff(
     const key_type& k, F f, B b, Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::updates);
     int                           v = -1;
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        k,
         [](hash_ptr_reference t, const key_type& k, F f, B b,
            Types&&... args)                              //
         -> std::pair<int, base_table_insert_return_type> //
@@ -727,11 +896,13 @@ migration_table_handle<migration_table_data>::update_unsafe(const key_type& k,
                                                             F               f,
                                                             Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::updates);
     int                           v = -1;
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        k,
         [](hash_ptr_reference t, const key_type& k, F f,
            Types&&... args) -> std::pair<int, base_table_insert_return_type> {
             std::pair<int, base_table_insert_return_type> result =
@@ -769,6 +940,7 @@ inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::insert_or_update(
     const key_type& k, const mapped_type& d, F f, Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::insert_or_updates);
     auto slot = slot_type(k, d);
     auto result =
         insert_or_update_intern(slot, f, std::forward<Types>(args)...);
@@ -787,6 +959,7 @@ migration_table_handle<migration_table_data>::emplace_or_update(key_type&&    k,
                                                                 F             f,
                                                                 Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::insert_or_updates);
     auto slot = slot_type(std::move(k), std::move(d));
     auto result =
         insert_or_update_intern(slot, f, std::forward<Types>(args)...);
@@ -807,7 +980,8 @@ migration_table_handle<migration_table_data>::insert_or_update_intern(
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        slot.get_key_ref(),
         [](hash_ptr_reference t, slot_type& slot, F f,
            Types&&... args) -> std::pair<int, base_table_insert_return_type> {
             auto hash = t->h(slot.get_key_ref());
@@ -848,6 +1022,7 @@ inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::insert_or_update_unsafe(
     const key_type& k, const mapped_type& d, F f, Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::insert_or_updates);
     auto slot = slot_type(k, d);
     auto result =
         insert_or_update_unsafe_intern(slot, f, std::forward<Types>(args)...);
@@ -864,6 +1039,7 @@ inline typename migration_table_handle<migration_table_data>::insert_return_type
 migration_table_handle<migration_table_data>::emplace_or_update_unsafe(
     key_type&& k, mapped_type&& d, F f, Types&&... args)
 {
+    auto op_stats = _stats.count_op(&stats_counters::insert_or_updates);
     auto slot = slot_type(std::move(k), std::move(d));
     auto result =
         insert_or_update_unsafe_intern(slot, f, std::forward<Types>(args)...);
@@ -884,7 +1060,8 @@ migration_table_handle<migration_table_data>::insert_or_update_unsafe_intern(
     base_table_insert_return_type result =
         std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        slot.get_key_ref(),
         [](hash_ptr_reference t, slot_type& slot, F f,
            Types&&... args) -> std::pair<int, base_table_insert_return_type> {
             auto hash = t->h(slot.get_key_ref());
@@ -925,9 +1102,12 @@ template <class migration_table_data>
 inline typename migration_table_handle<migration_table_data>::iterator
 migration_table_handle<migration_table_data>::find(const key_type& k)
 {
+    if constexpr (parent_type::nohelp_finds) return find_nohelp(k);
+    auto op_stats = _stats.count_op(&stats_counters::finds);
     int                 v   = -1;
     base_table_iterator bit = bend();
-    std::tie(v, bit)        = execute(
+    std::tie(v, bit)        = execute_at(
+        k,
         [](hash_ptr_reference t,
            const key_type&    k) -> std::pair<int, base_table_iterator> {
             return std::make_pair<int, base_table_iterator>(t->_version,
@@ -941,25 +1121,226 @@ template <class migration_table_data>
 inline typename migration_table_handle<migration_table_data>::const_iterator
 migration_table_handle<migration_table_data>::find(const key_type& k) const
 {
+    auto op_stats = _stats.count_op(&stats_counters::finds);
+    auto lookup   = [](hash_ptr_reference t, const key_type& k)
+        -> std::pair<int, base_table_citerator> {
+        const base_table_type& ct = *t;
+        return std::make_pair<int, base_table_citerator>(t->_version,
+                                                         ct.find(k));
+    };
     int                  v   = -1;
     base_table_citerator bit = bcend();
-    std::tie(v, bit)         = cexecute(
+    if constexpr (parent_type::nohelp_finds)
+        std::tie(v, bit) = execute_nohelp(k, lookup, k);
+    else
+        std::tie(v, bit) = cexecute_at(k, lookup, k);
+    return make_citerator(bit, v);
+}
+
+template <class migration_table_data>
+inline typename migration_table_handle<migration_table_data>::iterator
+migration_table_handle<migration_table_data>::find_nohelp(const key_type& k)
+{
+    static_assert(exclusion_strat::nohelp_reads,
+                  "find_nohelp cannot be used with hmod::sync");
+    auto op_stats = _stats.count_op(&stats_counters::finds);
+    int                 v   = -1;
+    base_table_iterator bit = bend();
+    std::tie(v, bit)        = execute_nohelp(
+        k,
         [](hash_ptr_reference t,
-           const key_type&    k) -> std::pair<int, base_table_citerator> {
+           const key_type&    k) -> std::pair<int, base_table_iterator> {
             return std::make_pair<int, base_table_iterator>(t->_version,
                                                             t->find(k));
         },
         k);
-    return make_citerator(bit, v);
+    return make_iterator(bit, v);
+}
+
+// BATCHED FUNCTIONALITY *******************************************************
+
+template <class migration_table_data>
+template <class F>
+inline typename migration_table_handle<migration_table_data>::size_type
+migration_table_handle<migration_table_data>::find_batch(
+    std::span<const key_type> keys, F f)
+{
+    auto op_stats = _stats.count_op(&stats_counters::finds, keys.size());
+    // found elements stay alive until f was called for them (the iterators
+    // passed to f hold their own guard)
+    [[maybe_unused]] reclamation_guard_type guard;
+    constexpr size_type block    = base_table_type::batch_block_size;
+    constexpr size_type distance = base_table_type::batch_prefetch_distance;
+
+    size_type                        found = 0;
+    std::vector<base_table_iterator> bits;
+    bits.reserve(std::min(block, keys.size()));
+
+    for (size_type b = 0; b < keys.size(); b += block)
+    {
+        size_type n = std::min(block, keys.size() - b);
+        bits.clear();
+
+        // keys are routed one by one while a migration is pending (without
+        // helping, they are always routed)
+        if constexpr (exclusion_strat::incremental)
+        {
+            if (parent_type::nohelp_finds ||
+                _local_exclusion.migration_pending())
+            {
+                for (size_type i = 0; i < n; ++i)
+                {
+                    auto it = find(keys[b + i]);
+                    if (it != end()) ++found;
+                    f(b + i, it);
+                }
+                continue;
+            }
+        }
+
+        // the table is only protected while the probes are resolved,
+        // f is called afterwards (it might use this handle)
+        auto resolve = [&](hash_ptr_reference t) -> int {
+            size_type hashes[block];
+            t->h_batch(
+                n, [&](size_type i) { return keys[b + i]; }, hashes);
+            for (size_type i = 0; i < std::min(distance, n); ++i)
+                t->prefetch(hashes[i]);
+
+            for (size_type i = 0; i < n; ++i)
+            {
+                if (i + distance < n) t->prefetch(hashes[i + distance]);
+                bits.push_back(t->find_intern(keys[b + i], hashes[i]));
+            }
+            return t->_version;
+        };
+        // (here, the table read without helping does not depend on the key)
+        int v;
+        if constexpr (parent_type::nohelp_finds)
+            v = execute_nohelp(keys[b], resolve);
+        else
+            v = execute(resolve);
+
+        for (size_type i = 0; i < n; ++i)
+        {
+            if (bits[i] != bend()) ++found;
+            f(b + i, make_iterator(bits[i], v));
+        }
+    }
+    return found;
+}
+
+template <class migration_table_data>
+inline typename migration_table_handle<migration_table_data>::size_type
+migration_table_handle<migration_table_data>::insert_batch(
+    std::span<const batch_element_type> elements)
+{
+    auto op_stats = _stats.count_op(&stats_counters::inserts, elements.size());
+    return batch_intern(
+        elements,
+        [](hash_ptr_reference t, const slot_type& slot, size_type hash) {
+            return t->insert_intern(slot, hash).second;
+        },
+        [this](const batch_element_type& e) {
+            return insert(e.first, e.second).second;
+        });
+}
+
+template <class migration_table_data>
+template <class F, class... Types>
+inline typename migration_table_handle<migration_table_data>::size_type
+migration_table_handle<migration_table_data>::insert_or_update_batch(
+    std::span<const batch_element_type> elements, F f, Types&&... args)
+{
+    auto op_stats =
+        _stats.count_op(&stats_counters::insert_or_updates, elements.size());
+    return batch_intern(
+        elements,
+        [&f, &args...](hash_ptr_reference t, const slot_type& slot,
+                       size_type hash) {
+            return t->insert_or_update_intern(slot, hash, f, args...).second;
+        },
+        [this, &f, &args...](const batch_element_type& e) {
+            return insert_or_update(e.first, e.second, f, args...).second;
+        });
+}
+
+// Resolves a block of operations within one table protection. When an
+// operation needs the table to grow (UNSUCCESS_FULL/UNSUCCESS_INVALID), the
+// block is interrupted and the element is handled by the single element
+// operation sop (which grows or helps), afterwards the batch continues.
+template <class migration_table_data>
+template <class BaseOp, class SingleOp>
+inline typename migration_table_handle<migration_table_data>::size_type
+migration_table_handle<migration_table_data>::batch_intern(
+    std::span<const batch_element_type> elements, BaseOp bop, SingleOp sop)
+{
+    constexpr size_type block    = base_table_type::batch_block_size;
+    constexpr size_type distance = base_table_type::batch_prefetch_distance;
+
+    size_type inserted = 0;
+    size_type i        = 0;
+    while (i < elements.size())
+    {
+        size_type  end       = std::min(elements.size(), i + block);
+        size_type  local_ins = 0;
+        ReturnCode code      = ReturnCode::SUCCESS_IN;
+
+        std::tie(i, code) = execute(
+            [&](hash_ptr_reference t) -> std::pair<size_type, ReturnCode> {
+                size_type hashes[block];
+                t->h_batch(
+                    end - i,
+                    [&](size_type j) { return elements[i + j].first; },
+                    hashes);
+                for (size_type j = i; j < std::min(i + distance, end); ++j)
+                    t->template prefetch<true>(hashes[j - i]);
+
+                for (size_type j = i; j < end; ++j)
+                {
+                    if (j + distance < end)
+                        t->template prefetch<true>(hashes[j + distance - i]);
+
+                    auto slot = slot_type(elements[j].first,
+                                          elements[j].second, hashes[j - i]);
+                    auto rcode = bop(t, slot, hashes[j - i]);
+
+                    if (rcode == ReturnCode::SUCCESS_IN)
+                    {
+                        ++local_ins;
+                        continue;
+                    }
+                    if constexpr (slot_config::needs_cleanup) slot.cleanup();
+                    if (rcode == ReturnCode::UNSUCCESS_FULL ||
+                        rcode == ReturnCode::UNSUCCESS_INVALID)
+                        return std::make_pair(j, rcode);
+                }
+                return std::make_pair(end, ReturnCode::SUCCESS_IN);
+            });
+
+        // counters are updated outside of the protected area (they can
+        // trigger a grow)
+        inserted += local_ins;
+        for (size_type j = 0; j < local_ins; ++j) inc_inserted();
+
+        if (code != ReturnCode::SUCCESS_IN)
+        {
+            if (sop(elements[i])) ++inserted;
+            ++i;
+        }
+    }
+    return inserted;
 }
 
 template <class migration_table_data>
 inline typename migration_table_handle<migration_table_data>::size_type
 migration_table_handle<migration_table_data>::erase(const key_type& k)
 {
+    auto op_stats = _stats.count_op(&stats_counters::erases);
     int        v        = -1;
     ReturnCode result   = ReturnCode::ERROR;
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        k,
         [](hash_ptr_reference t,
            const key_type&    k) -> std::pair<int, ReturnCode> {
             std::pair<int, ReturnCode> result =
@@ -994,9 +1375,11 @@ inline typename migration_table_handle<migration_table_data>::size_type
 migration_table_handle<migration_table_data>::erase_if(const key_type&    k,
                                                        const mapped_type& d)
 {
+    auto op_stats = _stats.count_op(&stats_counters::erases);
     int        v        = -1;
     ReturnCode result   = ReturnCode::ERROR;
-    std::tie(v, result) = execute(
+    std::tie(v, result) = execute_at(
+        k,
         [](hash_ptr_reference t, const key_type& k,
            const mapped_type& d) -> std::pair<int, ReturnCode> {
             std::pair<int, ReturnCode> result =
@@ -1037,6 +1420,7 @@ template <class migration_table_data>
 inline typename migration_table_handle<migration_table_data>::iterator
 migration_table_handle<migration_table_data>::begin()
 {
+    complete_migration();
     return execute(
         [](hash_ptr_reference t, migration_table_handle& gt) -> iterator {
             return iterator(t->begin(), t->_version, gt);
@@ -1057,6 +1441,7 @@ inline typename migration_table_handle<migration_table_data>::const_iterator
 migration_table_handle<migration_table_data>::cbegin() const
 {
     // return begin();
+    complete_migration();
     return cexecute(
         [](hash_ptr_reference            t,
            const migration_table_handle& gt) -> const_iterator {
@@ -1069,10 +1454,7 @@ inline typename migration_table_handle<migration_table_data>::const_iterator
 migration_table_handle<migration_table_data>::cend() const
 {
     // return end();
-    return const_iterator(base_table_citerator(std::pair<key_type, mapped_type>(
-                                                   key_type(), mapped_type()),
-                                               nullptr, nullptr),
-                          0, *this);
+    return const_iterator(bcend(), 0, *this);
 }
 
 
@@ -1082,67 +1464,104 @@ migration_table_handle<migration_table_data>::cend() const
 // COUNTING FUNCTIONALITY ******************************************************
 
 template <class migration_table_data>
-inline void migration_table_handle<migration_table_data>::update_numbers()
+inline void
+migration_table_handle<migration_table_data>::update_numbers(bool forward_leaf)
 {
-    _counts._updates = 0;
+    if (!forward_leaf && !_counts.pending()) return;
 
     auto table = get_table();
-    // if (table->version != size_t(_counts._version))
-    // {
-    //     _counts.set(table->_version, 0,0,0);
-    //     rls_table();
-    //     return;
-    // }
 
-    _mt_data._dummies.fetch_add(_counts._deleted, std::memory_order_relaxed);
+    // only pushes that reach the root of the combining tree can change the
+    // global occupancy (and trigger a migration)
+    auto pushed = _counts.push(table->capacity(), forward_leaf);
+    if (!pushed)
+    {
+        rls_table();
+        return;
+    }
+    auto curr = pushed->second;
 
-    auto temp = _mt_data._elements.fetch_add(_counts._inserted,
-                                             std::memory_order_relaxed);
-    temp += _counts._inserted;
+    // both checks are level triggered (a threshold that is crossed during a
+    // migration is seen by the next push), repeated calls are cheap, since
+    // the strategies start only one migration per table version
+    size_t thresh = table->capacity() * _max_fill_factor;
+    if (curr.elements > thresh)
+    {
+        int v = table->_version;
+        rls_table();
+        grow(v);
+        return;
+    }
 
-    int thresh = table->capacity() * _max_fill_factor;
-    if (temp > thresh)
+    // shrink when the number of live elements is below the low-water mark
+    // (only if resize is allowed to halve the table, otherwise each push
+    // would start a migration that keeps the size)
+    auto slots = table->_mapper.addressable_slots();
+    if (_mt_data._min_fill_factor > 0. &&
+        slots > base_mapper_type::min_capacity &&
+        (slots >> 1) >= _mt_data._reserved.load(std::memory_order_relaxed))
     {
-        if (temp - _counts._inserted < thresh)
+        int64_t low_thresh = table->capacity() * _mt_data._min_fill_factor;
+        if (curr.live() < low_thresh)
         {
             int v = table->_version;
             rls_table();
             grow(v);
-            _counts.set(0, 0, 0);
             return;
         }
     }
     rls_table();
-    _counts.set(0, 0, 0);
 }
 
 template <class migration_table_data>
-inline void migration_table_handle<migration_table_data>::inc_inserted()
+inline typename migration_table_handle<migration_table_data>::size_type
+migration_table_handle<migration_table_data>::bulk_insert_unsafe(
+    std::span<const batch_element_type> elements, size_type num_threads)
 {
-    // if (_counts._version == v)
+    auto n = execute(
+        [&](hash_ptr_reference t) {
+            return t->bulk_insert_unsafe(elements, num_threads);
+        });
+    _mt_data._element_count.add_bulk(n);
+    return n;
+}
+
+template <class migration_table_data>
+inline void
+migration_table_handle<migration_table_data>::reserve(size_type n)
+{
+    // same capacity computation as for the initial table
+    auto cap  = base_mapper_type(n).addressable_slots();
+    auto prev = _mt_data._reserved.load(std::memory_order_acquire);
+    while (prev < cap && !_mt_data._reserved.compare_exchange_weak(
+                             prev, cap, std::memory_order_acq_rel))
+    { /* retry, someone else reserved concurrently */
+    }
+
+    // concurrent growing steps might have started before the reservation
+    // was visible, therefore, we check again after each migration
+    while (true)
     {
-        ++_counts._inserted;
-        if (++_counts._updates > 64) { update_numbers(); }
+        auto table   = get_table();
+        auto current = table->_mapper.addressable_slots();
+        int  v       = table->_version;
+        rls_table();
+        if (current >= cap) return;
+        grow(v);
     }
-    // else
-    // {
-    //     _counts.set(v,1,1,0);
-    // }
+}
+
+template <class migration_table_data>
+inline void migration_table_handle<migration_table_data>::inc_inserted()
+{
+    if (_counts.inc_inserted()) update_numbers();
 }
 
 
 template <class migration_table_data>
 inline void migration_table_handle<migration_table_data>::inc_deleted()
 {
-    // if (_counts._version == v)
-    {
-        ++_counts._deleted;
-        if (++_counts._updates > 64) { update_numbers(); }
-    }
-    // else
-    // {
-    //     _counts.set(v,1,0,1);
-    // }
+    if (_counts.inc_deleted()) update_numbers();
 }
 
 // template <typename migration_table_data>
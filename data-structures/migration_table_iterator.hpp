@@ -13,6 +13,7 @@
 #include <functional>
 
 #include "base_linear_iterator.hpp"
+#include "epoch_reclamation.hpp"
 
 namespace growt
 {
@@ -46,6 +47,8 @@ class migration_table_mapped_reference
         typename table_type::base_table_type::reference::mapped_ref>::type;
 
     using hash_ptr_reference = typename table_type::hash_ptr_reference;
+    using reclamation_guard_type =
+        epoch_guard<table_type::slot_config::needs_reclamation>;
 
     template <class, bool>
     friend class migration_table_reference;
@@ -58,11 +61,18 @@ class migration_table_mapped_reference
     {
     }
 
+    // each copy holds its own guard
+    migration_table_mapped_reference(const migration_table_mapped_reference& rhs)
+        : _tab(rhs._tab), _version(rhs._version), _mref(rhs._mref)
+    {
+    }
+
 
     // Functions necessary for concurrency *************************************
     inline void refresh()
     {
-        _tab.execute(
+        _tab.execute_at(
+            _mref._copy.get_key(),
             [&](hash_ptr_reference t, this_type& sref) -> int {
                 base_refresh_ptr(t);
                 sref.ref.refresh();
@@ -78,21 +88,25 @@ class migration_table_mapped_reference
     {
         static_assert(!is_const,
                       "assignment operator called on a const_mapped_reference");
-        _tab.execute(
+        // a migrated slot cannot be written, the assignment is repeated once
+        // the next table is used
+        while (!_tab.execute_at(
+            _mref._copy.get_key(),
             [](hash_ptr_reference t, this_type& sref,
-               const mapped_type& value) -> int {
+               const mapped_type& value) -> bool {
                 sref.base_refresh_ptr(t);
-                sref._mref.operator=(value);
-                return 0;
+                return sref._mref.assign(value);
             },
-            *this, value);
+            *this, value))
+            _tab.help_grow(_version);
         return *this;
     }
     template <class F, class... Args>
     inline void update(const mapped_type& value, F f, Args&&... args)
     {
         static_assert(!is_const, "update called on a const_mapped_reference");
-        _tab.execute(
+        _tab.execute_at(
+            _mref._copy.get_key(),
             [](hash_ptr_reference t, this_type& sref, const mapped_type& value,
                F f, Args&&... args) -> int {
                 sref.base_refresh_ptr(t);
@@ -105,7 +119,8 @@ class migration_table_mapped_reference
     {
         static_assert(!is_const,
                       "compare_exchange called on a const_mapped_reference");
-        return _tab.execute(
+        return _tab.execute_at(
+            _mref._copy.get_key(),
             [](hash_ptr_reference t, this_type& sref, const mapped_type& val) {
                 sref.base_refresh_ptr(t);
                 return sref._mref.compare_exchange(val);
@@ -116,9 +131,13 @@ class migration_table_mapped_reference
     inline operator mapped_type() const { return mapped_type(_mref); }
 
   private:
-    table_type&           _tab;
-    size_t                _version;
-    base_mapped_reference _mref;
+    // out-of-line elements (complex_slot) stay alive while the reference
+    // exists, it blocks reclamation and cannot be used by another thread
+    // (see epoch_guard)
+    [[no_unique_address]] reclamation_guard_type _guard;
+    table_type&                                  _tab;
+    size_t                                       _version;
+    base_mapped_reference                        _mref;
 
     // the table should be locked, while this is called
     inline bool base_refresh_ptr(hash_ptr_reference ht)
@@ -219,6 +238,8 @@ class migration_table_iterator
     using atomic_slot_type = typename slot_config::atomic_slot_type;
 
     using hash_ptr_reference = typename table_type::hash_ptr_reference;
+    using reclamation_guard_type =
+        epoch_guard<slot_config::needs_reclamation>;
     using base_table_type =
         typename std::conditional<is_const,
                                   const typename table_type::base_table_type,
@@ -268,6 +289,7 @@ class migration_table_iterator
     {
     }
 
+    // each copy holds its own guard
     migration_table_iterator(const migration_table_iterator& rhs)
         : _tab(rhs._tab), _version(rhs._version), _it(rhs._it)
     {
@@ -333,7 +355,8 @@ class migration_table_iterator
     // Functions necessary for concurrency *************************************
     inline void refresh()
     {
-        _tab.cexecute(
+        _tab.cexecute_at(
+            _it._copy.get_key(),
             [](hash_ptr_reference t, migration_table_iterator& sit) -> int {
                 sit.base_refresh_ptr(t);
                 sit._it.refresh();
@@ -346,7 +369,8 @@ class migration_table_iterator
     {
         while (true)
         {
-            auto res = _tab.cexecute(
+            auto res = _tab.cexecute_at(
+                _it._copy.get_key(),
                 [](hash_ptr_reference        t,
                    migration_table_iterator& sit) -> bool {
                     sit.base_refresh_ptr(t);
@@ -361,7 +385,8 @@ class migration_table_iterator
 
     inline bool erase_if_unchanged()
     {
-        auto res = _tab.cexecute(
+        auto res = _tab.cexecute_at(
+            _it._copy.get_key(),
             [](hash_ptr_reference t, migration_table_iterator& sit) -> bool {
                 auto val = sit._it._copy.get_key();
                 if (sit.base_refresh_ptr(t) && val != sit._it._copy.get_key())
@@ -374,9 +399,13 @@ class migration_table_iterator
     }
 
   private:
-    table_type&   _tab;
-    size_t        _version;
-    base_iterator _it;
+    // out-of-line elements (complex_slot) stay alive while the iterator
+    // exists, it blocks reclamation and cannot be used by another thread
+    // (see epoch_guard)
+    [[no_unique_address]] reclamation_guard_type _guard;
+    table_type&                                  _tab;
+    size_t                                       _version;
+    base_iterator                                _it;
 
     // the table should be locked, while this is called
     inline bool base_refresh_ptr(hash_ptr_reference ht)
@@ -0,0 +1,268 @@
+/*******************************************************************************
+ * data-structures/migration_trace.hpp
+ *
+ * Timeline of growing steps, enabled at compile time with -DGROWT_TRACE.
+ * The exclusion and worker strategies record per-thread events (grow and
+ * help_grow calls, migrated blocks, waiting for helpers, published epochs,
+ * retired tables). dump_trace() writes them in the Chrome trace event
+ * format, which can be opened with Perfetto (ui.perfetto.dev) or
+ * chrome://tracing. Without GROWT_TRACE all of this compiles to nothing.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace growt
+{
+
+#ifdef GROWT_TRACE
+inline constexpr bool trace_enabled = true;
+#else
+inline constexpr bool trace_enabled = false;
+#endif
+
+// names and argument names have to be string literals (they are not copied)
+struct trace_event
+{
+    const char* name;
+    const char* arg_name; // nullptr if there is no argument
+    size_t      arg;
+    uint64_t    start_ns;
+    uint64_t    duration_ns;
+    bool        instant;
+};
+
+// the events of one thread, the mutex is only contended while dumping
+struct trace_buffer
+{
+    size_t                   tid;
+    std::string              thread_name;
+    std::mutex               mutex;
+    std::vector<trace_event> events;
+};
+
+// process wide collection of all thread buffers (buffers of finished
+// threads are kept until the process ends, clear only removes events)
+class trace_log
+{
+  public:
+    // leaked on purpose, detached threads (see migration_executor.hpp) can
+    // still record events during static destruction
+    static trace_log& instance()
+    {
+        static trace_log* log = new trace_log();
+        return *log;
+    }
+
+    static uint64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - instance()._start)
+            .count();
+    }
+
+    trace_buffer& local_buffer()
+    {
+        thread_local trace_buffer* buffer = nullptr;
+        if (!buffer)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _buffers.emplace_back(std::make_unique<trace_buffer>());
+            buffer      = _buffers.back().get();
+            buffer->tid = _buffers.size();
+        }
+        return *buffer;
+    }
+
+    void record(const trace_event& event)
+    {
+        auto&                       buffer = local_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back(event);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& buffer : _buffers)
+        {
+            std::lock_guard<std::mutex> block(buffer->mutex);
+            buffer->events.clear();
+        }
+    }
+
+    // {"traceEvents":[...]}, timestamps are in microseconds
+    void dump(std::ostream& out)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        auto sep   = [&]() -> std::ostream& {
+            if (!first) out << ",";
+            first = false;
+            return out << "\n";
+        };
+        for (auto& buffer : _buffers)
+        {
+            std::lock_guard<std::mutex> block(buffer->mutex);
+            if (!buffer->thread_name.empty())
+                sep() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                      << "\"tid\":" << buffer->tid << ",\"args\":{\"name\":\""
+                      << json_escaped(buffer->thread_name) << "\"}}";
+            for (auto& e : buffer->events)
+            {
+                sep() << "{\"name\":\"" << e.name
+                      << "\",\"cat\":\"growt\",\"ph\":\""
+                      << ((e.instant) ? "i\",\"s\":\"t" : "X")
+                      << "\",\"pid\":1,\"tid\":" << buffer->tid
+                      << ",\"ts\":" << e.start_ns / 1000 << "."
+                      << micro_fraction(e.start_ns);
+                if (!e.instant)
+                    out << ",\"dur\":" << e.duration_ns / 1000 << "."
+                        << micro_fraction(e.duration_ns);
+                if (e.arg_name)
+                    out << ",\"args\":{\"" << e.arg_name << "\":" << e.arg
+                        << "}";
+                out << "}";
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+  private:
+    trace_log() : _start(std::chrono::steady_clock::now()) {}
+
+    // three digits after the decimal point of a microsecond value
+    static std::string micro_fraction(uint64_t ns)
+    {
+        auto frac = std::to_string(ns % 1000);
+        return std::string(3 - frac.size(), '0') + frac;
+    }
+
+    // thread names are user provided (event names are string literals)
+    static std::string json_escaped(const std::string& str)
+    {
+        std::string result;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                const char* hex = "0123456789abcdef";
+                result += "\\u00";
+                result += hex[c >> 4];
+                result += hex[c & 15];
+                continue;
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    std::chrono::steady_clock::time_point      _start;
+    std::mutex                                 _mutex;
+    std::vector<std::unique_ptr<trace_buffer>> _buffers;
+};
+
+
+
+// RECORDING *******************************************************************
+// a duration event (complete event) from construction to destruction
+template <bool enabled>
+class [[nodiscard]] basic_trace_scope
+{
+  public:
+    basic_trace_scope(const char* name,
+                      const char* arg_name = nullptr,
+                      size_t      arg      = 0)
+        : _name(name), _arg_name(arg_name), _arg(arg),
+          _start(trace_log::now())
+    {
+    }
+    basic_trace_scope(const basic_trace_scope&)            = delete;
+    basic_trace_scope& operator=(const basic_trace_scope&) = delete;
+    ~basic_trace_scope()
+    {
+        trace_log::instance().record(trace_event{
+            _name, _arg_name, _arg, _start, trace_log::now() - _start, false});
+    }
+
+  private:
+    const char* _name;
+    const char* _arg_name;
+    size_t      _arg;
+    uint64_t    _start;
+};
+
+template <>
+class [[nodiscard]] basic_trace_scope<false>
+{
+  public:
+    basic_trace_scope(const char*, const char* = nullptr, size_t = 0) {}
+    ~basic_trace_scope() {}
+};
+
+using trace_scope = basic_trace_scope<trace_enabled>;
+
+inline void trace_instant([[maybe_unused]] const char* name,
+                          [[maybe_unused]] const char* arg_name = nullptr,
+                          [[maybe_unused]] size_t      arg      = 0)
+{
+    if constexpr (trace_enabled)
+        trace_log::instance().record(
+            trace_event{name, arg_name, arg, trace_log::now(), 0, true});
+}
+
+// shown instead of the thread id (e.g. for pool threads)
+inline void trace_thread_name([[maybe_unused]] const std::string& name)
+{
+    if constexpr (trace_enabled)
+    {
+        auto& buffer = trace_log::instance().local_buffer();
+
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.thread_name = name;
+    }
+}
+
+
+
+// OUTPUT **********************************************************************
+// should be called while no table is growing (events of running migrations
+// are only recorded once their scope ends)
+inline void dump_trace([[maybe_unused]] std::ostream& out)
+{
+    if constexpr (trace_enabled) trace_log::instance().dump(out);
+}
+
+inline bool dump_trace([[maybe_unused]] const std::string& filename)
+{
+    if constexpr (!trace_enabled) return false;
+    std::ofstream out(filename);
+    if (!out) return false;
+    trace_log::instance().dump(out);
+    return bool(out);
+}
+
+inline void clear_trace()
+{
+    if constexpr (trace_enabled) trace_log::instance().clear();
+}
+
+} // namespace growt
@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * data-structures/numa_location.hpp
+ *
+ * Cpu and NUMA node the calling thread currently runs on (without libnuma).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace growt
+{
+
+struct cpu_location
+{
+    unsigned cpu  = 0;
+    unsigned node = 0;
+};
+
+// the result is only a hint, unpinned threads can be moved at any time
+inline cpu_location this_cpu_location()
+{
+    cpu_location loc;
+    if (syscall(SYS_getcpu, &loc.cpu, &loc.node, nullptr) != 0)
+        return cpu_location();
+    return loc;
+}
+
+} // namespace growt
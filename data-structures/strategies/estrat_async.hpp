@@ -11,6 +11,7 @@
  ******************************************************************************/
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -21,6 +22,10 @@ namespace dtm = utils_tm::debug_tm;
 #include "utils/memory_reclamation/counting_reclamation.hpp"
 namespace rtm = utils_tm::reclamation_tm;
 
+#include "data-structures/migration_scheduler.hpp"
+#include "data-structures/migration_trace.hpp"
+#include "data-structures/table_stats.hpp"
+
 /*******************************************************************************
  *
  * This is a exclusion strategy for our growtable.
@@ -47,6 +52,12 @@ namespace rtm = utils_tm::reclamation_tm;
  * but not change elements that have already been copied. This has to be
  * ensured through marking copied elements.
  *
+ * Migrations that keep the size (triggered by deleted dummies) also copy into
+ * a new table. They are not purged in place (like in estrat_sync), an update
+ * that was interrupted while probing through a cluster could continue after
+ * the cluster was compacted and insert behind a freed slot. Preventing this
+ * would need every update to wait for the end of each purge it overlaps.
+ *
  ******************************************************************************/
 
 namespace growt
@@ -95,7 +106,14 @@ class estrat_async
     using pointer_type        = typename rec_manager_type::pointer_type;
 
   public:
-    static constexpr size_t migration_block_size = 4096;
+    // operations wait for whole migrations (see estrat_incremental.hpp)
+    static constexpr bool incremental = false;
+    // finds can read the current table while it is migrated (see read_table)
+    static constexpr bool nohelp_reads = true;
+
+    // blocks are handed out in chunks (see migration_scheduler.hpp)
+    static constexpr size_t migration_block_size =
+        migration_scheduler::block_size;
 
     class local_data_type;
 
@@ -178,6 +196,10 @@ class estrat_async
       public:
         inline hash_ptr_reference get_table();
         inline void               rls_table() {}
+        // the table that answers a lookup of key without waiting (see
+        // migration_table_handle::find_nohelp)
+        template <class K>
+        inline hash_ptr_reference read_table(const K& key);
 
         void          grow(int version);
         void          help_grow(int version);
@@ -213,23 +235,57 @@ estrat_async<P>::local_data_type::get_table()
     return static_cast<hash_ptr_reference>(_table);
 }
 
+// The target of a migration is only changed once it is published (all
+// updates that find marked slots wait for the end of the migration), thus,
+// the current table (with its marked slots) holds the newest version of each
+// element until then. Published tables are migrated completely, they can be
+// used before their epoch is stored.
+template <class P>
+template <class K>
+typename estrat_async<P>::hash_ptr_reference
+estrat_async<P>::local_data_type::read_table(const K&)
+{
+    size_t t_epoch = _global._epoch.load(std::memory_order_acquire);
+    if (t_epoch > _epoch)
+    {
+        _rec_handle.unprotect(_table);
+        _table = _rec_handle.protect(_global._table);
+        _epoch = _table->_version;
+    }
+    return static_cast<hash_ptr_reference>(_table);
+}
+
 template <class P>
 void estrat_async<P>::local_data_type::grow([[maybe_unused]] int version)
 {
     dtm::if_debug("in grow expected version is weird!",
                   int(_table->_version) != version);
+    trace_scope trace("grow", "version", _table->_version);
 
-    auto new_table = _rec_handle.create_pointer(
-        _table->_mapper.resize(
-            _parent._elements.load(std::memory_order_acquire),
-            _parent._dummies.load(std::memory_order_acquire)),
-        _table->_version + 1);
-
-    _growable_table_type* nu_ll = nullptr;
-    if (!_table->next_table.compare_exchange_strong(nu_ll, new_table))
+    // the thresholds are checked after every push, i.e., the migration may
+    // already be triggered (then we only help)
+    if (!_table->next_table.load(std::memory_order_acquire))
     {
-        // another thread triggered the growing
-        _rec_handle.delete_raw(new_table);
+        auto occupancy = _parent._element_count.approx();
+
+        // same-size resizes are copied too (see the comment at the top)
+        auto new_table = _rec_handle.create_pointer(
+            _table->_mapper.resize(
+                occupancy.elements, occupancy.dummies,
+                _parent._min_fill_factor,
+                std::max<size_t>(
+                    _parent._reserved.load(std::memory_order_acquire),
+                    _table->min_migration_size())),
+            _table->_version + 1);
+
+        _growable_table_type* nu_ll = nullptr;
+        if (!_table->next_table.compare_exchange_strong(nu_ll, new_table))
+        {
+            // another thread triggered the growing
+            _rec_handle.delete_raw(new_table);
+        }
+        else
+            trace_instant("grow_triggered", "version", _table->_version + 1);
     }
 
     _worker_strat.execute_migration(*this, _epoch);
@@ -240,6 +296,7 @@ void estrat_async<P>::local_data_type::grow([[maybe_unused]] int version)
 template <class P>
 void estrat_async<P>::local_data_type::help_grow(int version)
 {
+    trace_scope trace("help_grow", "version", version);
     _worker_strat.execute_migration(*this, version); //_epoch);
     end_grow();
 }
@@ -295,14 +352,13 @@ estrat_async<P>::local_data_type::blockwise_migrate(base_table_type* source,
     size_t n = 0;
 
     // get block + while block legal migrate and get new block
-    size_t temp = source->_current_copy_block.fetch_add(migration_block_size);
-    while (temp < source->_mapper.addressable_slots())
+    migration_scheduler::helper_type helper(source->_copy_scheduler);
+    size_t                           start, end;
+    while (helper.next(start, end))
     {
-        n += source->migrate(
-            *target, temp,
-            std::min(uint(temp + migration_block_size),
-                     uint(source->_mapper.addressable_slots())));
-        temp = source->_current_copy_block.fetch_add(migration_block_size);
+        trace_scope trace("migrate_block", "slot", start);
+        n += source->migrate(*target, start, end);
+        ++this_thread_stats.migrated_blocks;
     }
     return n;
 }
@@ -322,12 +378,32 @@ template <class P>
 void estrat_async<P>::local_data_type::end_grow()
 {
     // wait for other helpers
-    while (_global._n_helper.load(std::memory_order_acquire)) {}
+    {
+        trace_scope trace("end_grow_wait");
+        while (_global._n_helper.load(std::memory_order_acquire)) {}
+    }
 
     // here we don't protect curr because this cannot be a pool thread
     auto curr = _table;
-    // next is unprotected here but we do not access it if we
-    auto next = curr->next_table.load();
+
+    // a target that could not store some displacements is replaced before it
+    // is published (only one of the competing replacements is kept)
+    auto next = _rec_handle.protect(curr->next_table);
+    while (next->displacement_overflow())
+    {
+        auto larger = _rec_handle.create_pointer(next->overflow_mapper(),
+                                                 curr->_version + 1);
+        next->migrate_overflowed(*larger);
+        auto expected = next;
+        if (curr->next_table.compare_exchange_strong(expected, larger,
+                                                     std::memory_order_acq_rel))
+            _rec_handle.safe_delete(next);
+        else
+            _rec_handle.delete_raw(larger);
+        _rec_handle.unprotect(next);
+        next = _rec_handle.protect(curr->next_table);
+    }
+    _rec_handle.unprotect(next);
 
     if (_global._table.compare_exchange_strong(curr, next,
                                                std::memory_order_acq_rel))
@@ -336,13 +412,14 @@ void estrat_async<P>::local_data_type::end_grow()
 
         // updates to the number of elements can have minor race conditions but
         // the overall number will be right
-        auto temp = _parent._dummies.exchange(0, std::memory_order_acq_rel);
-        _parent._elements.fetch_sub(temp, std::memory_order_release);
+        _parent._element_count.remove_dummies();
 
         // before this, no further operations can be done
         // thus next is safe because nothing could be inserted
         _global._epoch.store(next->_version, std::memory_order_release);
+        trace_instant("epoch_published", "version", next->_version);
 
+        trace_instant("table_retired", "version", _table->_version);
         _rec_handle.safe_delete(_table);
     }
 
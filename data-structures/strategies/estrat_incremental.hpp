@@ -0,0 +1,558 @@
+/*******************************************************************************
+ * data-structures/strategies/estrat_incremental.hpp
+ *
+ * Exclusion strategy that migrates in bounded steps done by the operations.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "utils/debug.hpp"
+namespace dtm = utils_tm::debug_tm;
+#include "utils/memory_reclamation/counting_reclamation.hpp"
+namespace rtm = utils_tm::reclamation_tm;
+
+#include "data-structures/migration_scheduler.hpp"
+#include "data-structures/migration_trace.hpp"
+#include "data-structures/table_stats.hpp"
+
+/*******************************************************************************
+ *
+ * This is a exclusion strategy for our growtable (the interface is described
+ * in estrat_async.hpp).
+ *
+ * This specific strategy migrates incrementally. Like the asynchronous
+ * strategy, elements are marked once they are copied, but no operation
+ * waits for the whole migration. Instead, each operation that sees a
+ * pending migration does a bounded step (migration_budget blocks): first
+ * the target table is initialized blockwise, afterwards the blocks of the
+ * source table are migrated. Then the operation is executed on one of the
+ * two tables (route): a key is only accessed in the target table, once the
+ * block that copies its cluster is done (migrate always copies whole
+ * clusters). Operations that find a marked slot in the source table
+ * migrate (or wait for) exactly that block before they are retried.
+ * The thread that migrates the last block publishes the target table.
+ *
+ ******************************************************************************/
+
+namespace growt
+{
+
+template <class Parent>
+class estrat_incremental
+{
+  private:
+    using this_type   = estrat_incremental<Parent>;
+    using parent_type = Parent;
+
+  public:
+    using base_table_type    = typename Parent::base_table_type;
+    using hash_ptr_reference = base_table_type*;
+    using hash_ptr           = base_table_type*;
+
+    static_assert(base_table_type::slot_config::allows_marking,
+                  "Incremental migration can only be chosen with a "
+                  "markable element!!!");
+    // targets are used while they are filled, therefore, they cannot be
+    // replaced, if an element does not fit (see
+    // base_linear::displacement_overflow)
+    static_assert(!base_table_type::slot_config::needs_position,
+                  "Incremental migration cannot be chosen with slots that "
+                  "limit the displacement (quotient_slot)");
+
+    // operations are routed by key and step the migration (see
+    // migration_table_handle::execute_at)
+    static constexpr bool incremental = true;
+    // finds can be routed without stepping the migration (see read_table)
+    static constexpr bool nohelp_reads = true;
+
+    static constexpr size_t migration_block_size =
+        migration_scheduler::block_size;
+    // blocks (initialized or migrated) per operation
+    static constexpr size_t migration_budget = 2;
+    // target slots per initialization block (targets are usually twice as
+    // large as their source)
+    static constexpr size_t init_block_size = 2 * migration_block_size;
+
+  private:
+    using mapper_type = typename base_table_type::mapper_type;
+
+    enum block_state : uint8_t
+    {
+        block_free    = 0,
+        block_claimed = 1,
+        block_done    = 2
+    };
+
+    class _growable_table_type : public base_table_type
+    {
+      public:
+        // the first table is initialized on construction
+        _growable_table_type(size_t cap)
+            : base_table_type(cap), next_table(nullptr),
+              num_blocks(blocks(this->_mapper.addressable_slots(),
+                                migration_block_size)),
+              block_states(
+                  std::make_unique<std::atomic_uint8_t[]>(num_blocks)),
+              num_init_blocks(0)
+        {
+        }
+        // targets are initialized by the operations (see step)
+        _growable_table_type(mapper_type mapper, size_t version)
+            : base_table_type(mapper, version, true), next_table(nullptr),
+              num_blocks(blocks(this->_mapper.addressable_slots(),
+                                migration_block_size)),
+              block_states(
+                  std::make_unique<std::atomic_uint8_t[]>(num_blocks)),
+              num_init_blocks(
+                  blocks(this->_mapper.total_slots(), init_block_size))
+        {
+        }
+
+        std::atomic<_growable_table_type*> next_table;
+
+        // AS SOURCE: STATE OF EACH MIGRATION BLOCK
+        size_t                                 num_blocks;
+        std::unique_ptr<std::atomic_uint8_t[]> block_states;
+        std::atomic_size_t                     next_block{0};
+        std::atomic_size_t                     blocks_done{0};
+
+        // AS TARGET: BLOCKWISE INITIALIZATION
+        size_t             num_init_blocks;
+        std::atomic_size_t next_init{0};
+        std::atomic_size_t inits_done{0};
+
+        bool initialized() const
+        {
+            return inits_done.load(std::memory_order_acquire) ==
+                   num_init_blocks;
+        }
+
+        // the source block that copies the cluster starting at slot
+        std::atomic_uint8_t& block_state(size_t slot)
+        {
+            return block_states[slot / migration_block_size];
+        }
+
+      private:
+        static size_t blocks(size_t slots, size_t size)
+        {
+            return (slots + size - 1) / size;
+        }
+    };
+
+    using rec_manager_type    = rtm::counting_manager<_growable_table_type>;
+    using rec_handle_type     = typename rec_manager_type::handle_type;
+    using atomic_pointer_type = typename rec_manager_type::atomic_pointer_type;
+    using pointer_type        = typename rec_manager_type::pointer_type;
+
+    // completes a migration without synchronization (no other thread may
+    // access either table)
+    static void complete_unsafe(_growable_table_type& curr,
+                                _growable_table_type& next);
+
+  public:
+    class local_data_type;
+
+    // STORED AT THE GLOBAL OBJECT
+    //  - SHARED POINTER TO THE CURRENT TABLE (THE TARGET IS CONNECTED TO IT)
+    //  - VERSION COUNTER
+    class global_data_type
+    {
+      public:
+        global_data_type(size_t capacity)
+            : _epoch(0), _table(nullptr), _rec_manager()
+        {
+            auto temp_rec_handle = _rec_manager.get_handle();
+            auto temp_ptr        = temp_rec_handle.create_pointer(capacity);
+            _table.store(temp_ptr, std::memory_order_relaxed);
+        }
+        global_data_type(const global_data_type& source) = delete;
+        global_data_type& operator=(const global_data_type& source) = delete;
+        ~global_data_type()
+        {
+            auto temp_rec_handle = _rec_manager.get_handle();
+
+            // a migration can still be pending, its elements are spread
+            // over both tables, therefore, it is completed first
+            auto curr = _table.load();
+            if (auto next = curr->next_table.load())
+            {
+                complete_unsafe(*curr, *next);
+                _table.store(next);
+                temp_rec_handle.delete_raw(curr);
+            }
+
+            // base tables have slot cleanup disabled
+            // (otherwise slots would be removed during migration)
+            // we have to do this here
+            if constexpr (base_table_type::slot_config::needs_cleanup)
+                _table.load()->slot_cleanup();
+
+            // this is an unsafe deletion of a protected thing it should work
+            // fine
+            auto temp_ptr = _table.exchange(nullptr);
+            temp_rec_handle.delete_raw(temp_ptr);
+        }
+
+      private:
+        friend local_data_type;
+
+        std::atomic_size_t  _epoch;
+        atomic_pointer_type _table;
+        rec_manager_type    _rec_manager;
+    };
+
+    // STORED AT EACH HANDLE
+    //  - CACHED TABLES (CURRENT AND TARGET) AND VERSION NUMBER
+    //  - CONNECTIONS TO THE  WORKER STRATEGY AND THE GLOBAL TABLE
+    class local_data_type
+    {
+      private:
+        using worker_strat_local =
+            typename Parent::worker_strat::local_data_type;
+
+      public:
+        local_data_type(Parent& parent, worker_strat_local& wstrat)
+            : _parent(parent), _global(parent._global_exclusion),
+              _worker_strat(wstrat), _epoch(0), _table(nullptr),
+              _next(nullptr), _claim_own_block(false),
+              _rec_handle(_global._rec_manager.get_handle())
+        {
+        }
+
+        local_data_type(const local_data_type& source) = delete;
+        local_data_type& operator=(const local_data_type& source) = delete;
+
+        local_data_type(local_data_type&& source) = default;
+        local_data_type& operator=(local_data_type&& source) = default;
+        ~local_data_type()                                   = default;
+
+        inline void init();
+        inline void deinit() {}
+
+      private:
+        Parent&             _parent;
+        global_data_type&   _global;
+        worker_strat_local& _worker_strat;
+        size_t              _epoch;
+        pointer_type        _table;
+        pointer_type        _next; // target of _table (once it is seen)
+        bool                _claim_own_block;
+        rec_handle_type     _rec_handle;
+
+
+      public:
+        inline hash_ptr_reference get_table();
+        inline void               rls_table() {}
+
+        // the table that holds key (table is the result of get_table)
+        template <class K>
+        inline hash_ptr_reference route(hash_ptr_reference table,
+                                        const K&           key);
+        // the table that answers a lookup of key, neither steps the
+        // migration nor waits (see migration_table_handle::find_nohelp)
+        template <class K>
+        inline hash_ptr_reference read_table(const K& key);
+        inline bool               migration_pending();
+        inline void               step(size_t budget = migration_budget);
+        // whole-table operations (e.g. iteration) wait for the end of a
+        // pending migration and help with all remaining blocks
+        void                      complete_migration();
+
+        void          grow(int version);
+        void          help_grow(int version);
+        inline size_t migrate();
+
+      private:
+        inline void load();
+        inline void migrate_block(size_t block);
+        inline void finish();
+    };
+
+    static std::string name() { return "e_incremental"; }
+};
+
+
+template <class P>
+void estrat_incremental<P>::complete_unsafe(_growable_table_type& curr,
+                                            _growable_table_type& next)
+{
+    for (auto b = next.next_init.load(); b < next.num_init_blocks; ++b)
+        next.initialize_slots(b * init_block_size, (b + 1) * init_block_size);
+
+    auto slots = curr._mapper.addressable_slots();
+    for (size_t b = 0; b < curr.num_blocks; ++b)
+    {
+        if (curr.block_states[b].load() != block_free) continue;
+        curr.migrate(next, b * migration_block_size,
+                     std::min((b + 1) * migration_block_size, slots));
+    }
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::init()
+{
+    _table = _rec_handle.protect(_global._table);
+    while (_table->_version != _global._epoch.load(std::memory_order_relaxed))
+    { /* wait */
+    }
+    _epoch = _table->_version;
+}
+
+template <class P>
+typename estrat_incremental<P>::hash_ptr_reference
+estrat_incremental<P>::local_data_type::get_table()
+{
+    size_t t_epoch = _global._epoch.load(std::memory_order_acquire);
+    if (t_epoch > _epoch) { load(); }
+    return static_cast<hash_ptr_reference>(_table);
+}
+
+template <class P>
+template <class K>
+typename estrat_incremental<P>::hash_ptr_reference
+estrat_incremental<P>::local_data_type::route(hash_ptr_reference table,
+                                              const K&           key)
+{
+    auto claim = std::exchange(_claim_own_block, false);
+    // nothing is inserted into the target before it is initialized
+    if (!_next || !_next->initialized()) return table;
+
+    auto hash = _table->h(key);
+    while (true)
+    {
+        size_t start;
+        auto   marked = _table->marked_cluster_start(hash, start);
+        auto&  state  = _table->block_state(start);
+        auto   curr   = state.load(std::memory_order_acquire);
+
+        // the cluster is copied completely, the source copy is frozen
+        if (marked && curr == block_done) return _next;
+        if (!claim) return table;
+
+        // the operation found a marked slot, it migrates (or waits for) the
+        // block that copies its cluster
+        if (curr == block_free &&
+            state.compare_exchange_strong(curr, block_claimed,
+                                          std::memory_order_acq_rel))
+        {
+            migrate_block(start / migration_block_size);
+            continue;
+        }
+        trace_scope trace("wait_block", "slot", start);
+        while (state.load(std::memory_order_acquire) != block_done)
+        { /* wait */
+        }
+    }
+}
+
+// Clusters in blocks that are not done are only changed in the source (also
+// while their block is migrated, operations on marked slots wait for it).
+// Published tables are migrated completely, they can be used before their
+// epoch is stored.
+template <class P>
+template <class K>
+typename estrat_incremental<P>::hash_ptr_reference
+estrat_incremental<P>::local_data_type::read_table(const K& key)
+{
+    size_t t_epoch = _global._epoch.load(std::memory_order_acquire);
+    if (t_epoch > _epoch)
+    {
+        if (_next)
+        {
+            _rec_handle.unprotect(_next);
+            _next = nullptr;
+        }
+        _rec_handle.unprotect(_table);
+        _table = _rec_handle.protect(_global._table);
+        _epoch = _table->_version;
+    }
+
+    if (!_next)
+    {
+        if (!_table->next_table.load(std::memory_order_acquire))
+            return static_cast<hash_ptr_reference>(_table);
+        _next = _rec_handle.protect(_table->next_table);
+    }
+    if (!_next->initialized()) return static_cast<hash_ptr_reference>(_table);
+
+    size_t start;
+    auto   marked = _table->marked_cluster_start(_table->h(key), start);
+    if (marked &&
+        _table->block_state(start).load(std::memory_order_acquire) ==
+            block_done)
+        return _next;
+    return static_cast<hash_ptr_reference>(_table);
+}
+
+template <class P>
+bool estrat_incremental<P>::local_data_type::migration_pending()
+{
+    get_table();
+    return _table->next_table.load(std::memory_order_acquire) != nullptr;
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::step(size_t budget)
+{
+    if (!migration_pending()) return;
+
+    // next is protected until the current table changes (see load), it
+    // cannot be freed before, since its own migration has to be finished
+    if (!_next) _next = _rec_handle.protect(_table->next_table);
+
+    // INITIALIZE THE TARGET (blocks that are claimed by other threads are
+    // not awaited, meanwhile operations only use the source)
+    while (budget && !_next->initialized())
+    {
+        auto b = _next->next_init.fetch_add(1, std::memory_order_acq_rel);
+        if (b >= _next->num_init_blocks) return;
+        {
+            trace_scope trace("init_block", "slot", b * init_block_size);
+            _next->initialize_slots(b * init_block_size,
+                                    (b + 1) * init_block_size);
+        }
+        _next->inits_done.fetch_add(1, std::memory_order_release);
+        --budget;
+    }
+    if (!_next->initialized()) return;
+
+    // MIGRATE THE SOURCE (blocks can also be claimed through route)
+    while (budget)
+    {
+        auto b = _table->next_block.fetch_add(1, std::memory_order_acq_rel);
+        if (b >= _table->num_blocks) return;
+
+        uint8_t expected = block_free;
+        if (!_table->block_states[b].compare_exchange_strong(
+                expected, block_claimed, std::memory_order_acq_rel))
+            continue;
+        migrate_block(b);
+        --budget;
+    }
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::complete_migration()
+{
+    while (migration_pending()) step(std::numeric_limits<size_t>::max());
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::grow(int version)
+{
+    get_table();
+    trace_scope trace("grow", "version", _table->_version);
+
+    // the table has grown since the operation (the new table is checked
+    // by the retried operation)
+    if (int(_table->_version) != version) return;
+
+    if (!_table->next_table.load(std::memory_order_acquire))
+    {
+        auto occupancy = _parent._element_count.approx();
+
+        auto new_table = _rec_handle.create_pointer(
+            _table->_mapper.resize(
+                occupancy.elements, occupancy.dummies,
+                _parent._min_fill_factor,
+                _parent._reserved.load(std::memory_order_acquire)),
+            _table->_version + 1);
+
+        _growable_table_type* nu_ll = nullptr;
+        if (!_table->next_table.compare_exchange_strong(nu_ll, new_table))
+        {
+            // another thread triggered the growing
+            _rec_handle.delete_raw(new_table);
+        }
+        else
+            trace_instant("grow_triggered", "version", _table->_version + 1);
+    }
+
+    _worker_strat.execute_migration(*this, _epoch);
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::help_grow(int version)
+{
+    trace_scope trace("help_grow", "version", version);
+    // the retried operation is routed after the block of its cluster is
+    // migrated
+    _claim_own_block = true;
+    _worker_strat.execute_migration(*this, version);
+}
+
+template <class P>
+size_t estrat_incremental<P>::local_data_type::migrate()
+{
+    step();
+    return _epoch;
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::migrate_block(size_t block)
+{
+    auto start = block * migration_block_size;
+    {
+        trace_scope trace("migrate_block", "slot", start);
+        _table->migrate(*_next, start,
+                        std::min(start + migration_block_size,
+                                 _table->_mapper.addressable_slots()));
+        ++this_thread_stats.migrated_blocks;
+    }
+    _table->block_states[block].store(block_done, std::memory_order_release);
+
+    if (_table->blocks_done.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        _table->num_blocks)
+        finish();
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::finish()
+{
+    // only the thread that migrated the last block gets here
+    _global._table.store(_next, std::memory_order_release);
+
+    // updates to the number of elements can have minor race conditions but
+    // the overall number will be right
+    _parent._element_count.remove_dummies();
+
+    _global._epoch.store(_next->_version, std::memory_order_release);
+    trace_instant("epoch_published", "version", _next->_version);
+
+    // the current operation can still use both tables, they stay protected
+    // until the next load
+    trace_instant("table_retired", "version", _table->_version);
+    _rec_handle.safe_delete(_table);
+}
+
+template <class P>
+void estrat_incremental<P>::local_data_type::load()
+{
+    if (_next)
+    {
+        _rec_handle.unprotect(_next);
+        _next = nullptr;
+    }
+    if (_table) _rec_handle.unprotect(_table);
+    _table = _rec_handle.protect(_global._table);
+    while (_table->_version != _global._epoch.load(std::memory_order_relaxed))
+    { /* wait */
+    }
+    _epoch = _table->_version;
+}
+
+} // namespace growt
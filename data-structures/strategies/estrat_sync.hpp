@@ -11,6 +11,7 @@
  ******************************************************************************/
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <limits>
@@ -23,6 +24,10 @@ namespace mark = utils_tm::mark;
 #include "utils/debug.hpp"
 namespace dtm = utils_tm::debug_tm;
 
+#include "data-structures/migration_scheduler.hpp"
+#include "data-structures/migration_trace.hpp"
+#include "data-structures/table_stats.hpp"
+
 /*******************************************************************************
  *
  * This is a exclusion strategy for our growtable.
@@ -69,7 +74,15 @@ template <class Parent> class estrat_sync
     using hash_ptr           = std::atomic<base_table_type*>;
     using hash_ptr_reference = base_table_type*;
 
-    static constexpr size_t migration_block_size = 4096;
+    // operations wait for whole migrations (see estrat_incremental.hpp)
+    static constexpr bool incremental = false;
+    // the old table is freed once the migration is done, finds have to wait
+    // for the new table (no find_nohelp)
+    static constexpr bool nohelp_reads = false;
+
+    // blocks are handed out in chunks (see migration_scheduler.hpp)
+    static constexpr size_t migration_block_size =
+        migration_scheduler::block_size;
 
   private:
     using mapper_type = typename base_table_type::mapper_type;
@@ -300,6 +313,7 @@ template <class P> void estrat_sync<P>::local_data_type::rls_table()
 
 template <class P> void estrat_sync<P>::local_data_type::grow(int version)
 {
+    trace_scope trace("grow", "version", version);
     // STAGE 1 GENERATE TABLE AND SWAP IT SIZE_TO NEXT
     // we are the only done who is growing the ds
     auto epoch = _global._epoch.load(std::memory_order_acquire);
@@ -330,18 +344,36 @@ template <class P> void estrat_sync<P>::local_data_type::grow(int version)
         return;
     }
 
-    auto next = new growable_table_type(
-        temp->_mapper.resize(_parent._elements.load(std::memory_order_acquire),
-                             _parent._dummies.load(std::memory_order_acquire)),
-        temp->_version + 1);
+    auto occupancy = _parent._element_count.approx();
+    auto nmapper   = temp->_mapper.resize(
+        occupancy.elements, occupancy.dummies, _parent._min_fill_factor,
+        std::max<size_t>(_parent._reserved.load(std::memory_order_acquire),
+                         temp->min_migration_size()));
+
+    // a same size migration only removes deleted dummies, since no operation
+    // can access the table during the migration, this is done in place
+    // (_next_table == current table). Positioned slots (quotient_slot) are
+    // copied, their target might have to be replaced (see below).
+    auto in_place =
+        !base_table_type::slot_config::needs_position &&
+        !nmapper.shrinking() &&
+        nmapper.addressable_slots() == temp->_mapper.addressable_slots();
+    auto next = (in_place)
+                    ? temp
+                    : new growable_table_type(nmapper, temp->_version + 1);
 
-    wait_for_table_op(temp);
+    {
+        trace_scope wait("wait_for_table_ops");
+        wait_for_table_op(temp);
+    }
+    if (in_place) temp->begin_purge(migration_block_size);
 
 
     // STAGE 2 ALL THREADS CAN ENTER THE MIGRATION
     auto should_be_null = temp->_next_table.exchange(next);
     dtm::if_debug("Error: _next_table pointer != nullptr in grow()",
                   should_be_null);
+    trace_instant("grow_triggered", "version", temp->_version + 1);
 
     // _protect.store(mark::mark<growing_flag>(temp),
     // std::memory_order_release);
@@ -350,23 +382,48 @@ template <class P> void estrat_sync<P>::local_data_type::grow(int version)
 
     // STAGE 3 WAIT FOR ALL THREADS, THEN CHANGE CURRENT TABLE
 
-    auto rem_dummies = _parent._dummies.load();
-    _parent._elements.fetch_sub(rem_dummies);
-    _parent._dummies.fetch_sub(rem_dummies);
+    _parent._element_count.remove_dummies();
 
     // STAGE 4ISH THREADS MAY CONTINUE MASTER WILL DELETE THE OLD TABLE
     auto should_be_marked_temp = _global._table.exchange(nullptr);
     dtm::if_debug("Error: _table has changed since marking it",
                   should_be_marked_temp != mark::mark<growing_flag>(temp));
 
-    wait_for_migration();
+    {
+        trace_scope wait("end_grow_wait");
+        wait_for_migration();
+    }
+
+    // a target that could not store some displacements is replaced (never
+    // the purged table itself, see in_place)
+    while (next->displacement_overflow())
+    {
+        dtm::if_debug("Error: in place purge with displacement overflow",
+                      next == temp);
+        auto larger = new growable_table_type(next->overflow_mapper(),
+                                              temp->_version + 1);
+        next->migrate_overflowed(*larger);
+        temp->_next_table.store(larger, std::memory_order_release);
+        delete next;
+        next = larger;
+    }
+
+    if (in_place)
+    {
+        temp->end_purge();
+        temp->_next_table.store(nullptr, std::memory_order_release);
+    }
 
     should_be_null = _global._table.exchange(next);
     dtm::if_debug("Error: _table has changed since replacing it with nullptr",
                   should_be_marked_temp != mark::mark<growing_flag>(temp));
+    trace_instant("epoch_published", "version", temp->_version + 1);
 
-
-    delete temp;
+    if (!in_place)
+    {
+        trace_instant("table_retired", "version", temp->_version);
+        delete temp;
+    }
 }
 
 template <class P>
@@ -374,6 +431,7 @@ void estrat_sync<P>::local_data_type::help_grow([[maybe_unused]] int version,
                                                 bool                 external)
 {
     dtm::if_debug("in help_grow, got here from external (how?)", external);
+    trace_scope trace("help_grow", "version", version);
     // wait till migration is safe
 
     _worker_strat.execute_migration(
@@ -420,7 +478,7 @@ template <class P> size_t estrat_sync<P>::local_data_type::migrate()
 
     blockwise_migrate(*curr, *next);
 
-    auto version = next->_version;
+    auto version = (next == curr) ? curr->_version + 1 : next->_version;
     _own_flags.mig_protect.store(nullptr, std::memory_order_release);
 
     return version;
@@ -436,13 +494,16 @@ estrat_sync<P>::local_data_type::blockwise_migrate(base_table_type& source,
     size_t n = 0;
 
     // get block + while block legal migrate and get new block
-    size_t temp = source._current_copy_block.fetch_add(migration_block_size);
-    while (temp < source._mapper.addressable_slots())
+    migration_scheduler::helper_type helper(source._copy_scheduler);
+    size_t                           start, end;
+    while (helper.next(start, end))
     {
-        n += source.migrate(target, temp,
-                            std::min(uint(temp + migration_block_size),
-                                     uint(source._mapper.addressable_slots())));
-        temp = source._current_copy_block.fetch_add(migration_block_size);
+        trace_scope trace("migrate_block", "slot", start);
+        if (&source == &target)
+            n += source.purge(start, end);
+        else
+            n += source.migrate(target, start, end);
+        ++this_thread_stats.migrated_blocks;
     }
     return n;
 }
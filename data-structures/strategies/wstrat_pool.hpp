@@ -17,6 +17,8 @@
 #include <string>
 #include <thread>
 
+#include "data-structures/migration_trace.hpp"
+
 
 /*******************************************************************************
  *
@@ -114,16 +116,22 @@ void wstrat_pool<P>::grow_thread_loop(EStrat& estrat, global_data_type& global,
 {
     uint epoch = 0;
     pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), aff);
+    trace_thread_name("growt pool");
 
     while (true)
     {
         global._grow_wait.wait_if(epoch);
         if (finished) break;
 
-        auto next = estrat.migrate();
+        size_t next;
+        {
+            trace_scope trace("pool_migrate", "epoch", epoch);
+            next = estrat.migrate();
+        }
 
-        global._user_wait.inc_if(epoch);
-        global._user_wait.wake();
+        // only the thread that ends the epoch wakes the users, a late wake
+        // could end the wait for the next epoch
+        if (global._user_wait.inc_if(epoch)) global._user_wait.wake();
         epoch = next;
     }
     finished.store(2, std::memory_order_release);
@@ -197,7 +205,8 @@ void wstrat_pool<P>::local_data_type::execute_migration(ESLocal&, size_t epoch)
     // wait lazily until somebody did this zzzzZZZzz
     if (_global._grow_wait.inc_if(epoch)) _global._grow_wait.wake();
 
-    _global._user_wait.wait_if(epoch);
+    trace_scope trace("wait_for_pool", "epoch", epoch);
+    while (_global._user_wait.wait_if(epoch)) {}
 }
 
 } // namespace growt
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * data-structures/strategies/wstrat_shared.hpp
+ *
+ * Worker strategy that migrates with the process-wide executor threads.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include "counting_wait.hpp"
+#include <string>
+
+#include "data-structures/migration_executor.hpp"
+#include "data-structures/migration_trace.hpp"
+
+
+/*******************************************************************************
+ *
+ * This is a worker strategy for our growtable.
+ *
+ * Every worker strategy has to implement the following
+ *  - subclass: global_data_type      (is stored at the growtable object)
+ *  - subclass: local_data_type       (is stored at each handle)
+ *     - init(...)
+ *     - deinit()
+ *     - execute_migration(...)
+ *
+ * This specific strategy uses the process-wide migration_executor for
+ * growing. Like wstrat_pool, user threads only wait for the migration, but
+ * the migrating threads are shared by all handles and all tables of the
+ * process. Thus, creating handles does not spawn threads, and the number
+ * of migrating threads is bounded (by default one per cpu).
+ *
+ * Executor threads execute the migration through a temporary local object
+ * of the exclusion strategy. The table withdraws its job when it is
+ * destroyed (the worker data is destroyed before the tables).
+ *
+ ******************************************************************************/
+
+namespace growt
+{
+
+template <class Parent> class wstrat_shared
+{
+  public:
+    // Globaly we store the job that is published at the executor and one
+    // "waiting object" (futex) to sleep until the migration is finished.
+    class global_data_type
+    {
+      public:
+        global_data_type() : _user_wait(0) {}
+        global_data_type(const global_data_type&)            = delete;
+        global_data_type& operator=(const global_data_type&) = delete;
+
+        ~global_data_type()
+        {
+            if (_job.requested()) migration_executor::instance().withdraw(_job);
+        }
+
+      private:
+        friend wstrat_shared;
+
+        migration_executor::job_type _job;
+        counting_wait                _user_wait;
+    };
+
+
+    // This is the function executed by the executor threads
+    // create a temporary exclusion handle -> help grow -> wake the waiting
+    // user threads
+    template <class ESLocal> static void migration_job(void* parent, int epoch);
+
+
+    // No initialization or deinitialization needed.
+    // All migrations are reduced to waiting for the new table version
+    // which is created by the executor threads.
+    class local_data_type
+    {
+      public:
+        local_data_type(Parent& parent)
+            : _parent(parent), _global(parent._global_worker)
+        {
+        }
+        local_data_type(const local_data_type& source)            = delete;
+        local_data_type& operator=(const local_data_type& source) = delete;
+        local_data_type(local_data_type&& source)                 = default;
+        local_data_type& operator=(local_data_type&& source)      = default;
+        ~local_data_type()                                        = default;
+
+        Parent&           _parent;
+        global_data_type& _global;
+
+        template <class EStrat> inline void init(EStrat&) {}
+        inline void                         deinit() {}
+
+        template <class ESLocal>
+        inline void execute_migration(ESLocal&, size_t epoch);
+    };
+
+    static std::string name() { return "w_shared"; }
+};
+
+
+template <class P>
+template <class ESLocal>
+void wstrat_shared<P>::migration_job(void* parent, int epoch)
+{
+    auto&           par = *static_cast<P*>(parent);
+    local_data_type wlocal(par);
+    ESLocal         elocal(par, wlocal);
+
+    {
+        trace_scope trace("shared_migrate", "epoch", epoch);
+        elocal.migrate();
+    }
+
+    // only the thread that ends the epoch wakes the users
+    if (par._global_worker._user_wait.inc_if(epoch))
+        par._global_worker._user_wait.wake();
+}
+
+
+template <class P>
+template <class ESLocal>
+void wstrat_shared<P>::local_data_type::execute_migration(ESLocal&,
+                                                          size_t epoch)
+{
+    // lets instead tell the executor and ...
+    // wait until its threads finished the migration
+    migration_executor::instance().request(
+        _global._job, &migration_job<ESLocal>, &_parent, epoch);
+
+    trace_scope trace("wait_for_executor", "epoch", epoch);
+    while (_global._user_wait.wait_if(epoch)) {}
+}
+
+} // namespace growt
@@ -4,12 +4,17 @@
 #include <type_traits>
 
 #include "data-structures/element_types/complex_slot.hpp"
+#include "data-structures/element_types/key_only_slot.hpp"
+#include "data-structures/element_types/packed_slot.hpp"
+#include "data-structures/element_types/quotient_slot.hpp"
 #include "data-structures/element_types/simple_slot.hpp"
 #include "data-structures/element_types/single_word_slot.hpp"
 
 #include "data-structures/strategies/estrat_async.hpp"
+#include "data-structures/strategies/estrat_incremental.hpp"
 #include "data-structures/strategies/estrat_sync.hpp"
 #include "data-structures/strategies/wstrat_pool.hpp"
+#include "data-structures/strategies/wstrat_shared.hpp"
 #include "data-structures/strategies/wstrat_user.hpp"
 
 #include "data-structures/base_linear.hpp"
@@ -26,17 +31,19 @@ enum class slot_type_enum
     single_word_slot = 3
 };
 
+// IU (inplace updates) and SH (stored hash) are only relevant for complex
+// slots, small slots are always updated in place
 template <size_t, size_t, bool>
 struct slot_config
 {
-    template <class K, class M, bool NM>
-    using templ = complex_slot<K, M, NM>;
+    template <class K, class M, bool NM, bool IU, bool SH>
+    using templ = complex_slot<K, M, NM, default_allocator, IU, SH>;
 };
 
 template <>
 struct slot_config<16, 8, false>
 {
-    template <class K, class M, bool NM>
+    template <class K, class M, bool NM, bool IU, bool SH>
     using templ = simple_slot<K, M, NM>;
 };
 
@@ -44,17 +51,71 @@ struct slot_config<16, 8, false>
 template <>
 struct slot_config<8, 4, false>
 {
-    template <class K, class M, bool NM>
+    template <class K, class M, bool NM, bool IU, bool SH>
     using templ = single_word_slot<K, M, NM>;
 };
 
+// hash sets (mapped_type void) with unsigned integral keys only store the key
+template <bool>
+struct set_slot_config
+{
+    template <class K, class M, bool NM, bool IU, bool SH>
+    using templ = key_only_slot<K, NM>;
+};
+
+// keys and values with declared bit widths
+// (table_config<packed_bits<40>, packed_bits<23>, ...>) share one word
+template <class Key, class Data, class HashFct>
+struct packed_slot_config
+{
+    static constexpr bool is_packed = false;
+    using key_type                  = Key;
+    using mapped_type               = typename std::
+        conditional<std::is_void<Data>::value, empty_mapped_type, Data>::type;
+};
+
+template <size_t KeyBits, size_t ValueBits, class HashFct>
+struct packed_slot_config<packed_bits<KeyBits>,
+                          packed_bits<ValueBits>,
+                          HashFct>
+{
+    static constexpr bool is_packed = true;
+    using key_type                  = uint64_t;
+    using mapped_type               = uint64_t;
+
+    template <class K, class M, bool NM, bool IU, bool SH>
+    using templ = packed_slot<KeyBits, ValueBits, NM>;
+};
+
+// quotiented keys additionally drop the home slot bits of their hash
+// (HashFct has to be invertible, e.g. quotient_hash<KeyBits>)
+template <size_t KeyBits,
+          size_t MinQuotientBits,
+          size_t ValueBits,
+          class HashFct>
+struct packed_slot_config<quotient_bits<KeyBits, MinQuotientBits>,
+                          packed_bits<ValueBits>,
+                          HashFct>
+{
+    static constexpr bool is_packed = true;
+    using key_type                  = uint64_t;
+    using mapped_type               = uint64_t;
+
+    template <class K, class M, bool NM, bool IU, bool SH>
+    using templ =
+        quotient_slot<KeyBits, ValueBits, MinQuotientBits, HashFct, NM>;
+};
+
 template <class Key, class Data, class HashFct, class Allocator, hmod... Mods>
 class table_config
 {
+  private:
+    using packed_selection = packed_slot_config<Key, Data, HashFct>;
+
   public:
     // INPUT TYPES
-    using key_type       = Key;
-    using mapped_type    = Data;
+    using key_type       = typename packed_selection::key_type;
+    using mapped_type    = typename packed_selection::mapped_type;
     using hash_fct_type  = HashFct;
     using allocator_type = Allocator;
 
@@ -72,41 +133,85 @@ class table_config
     static constexpr bool needs_migration =
         mods::template is<hmod::growable>() ||
         mods::template is<hmod::deletion>();
+    static constexpr bool is_key_only_set = std::is_void<Data>::value &&
+                                            std::is_unsigned<Key>::value &&
+                                            !needs_growing_with_ref_integrity;
     // template <class K, class M, bool NM>
     // using slot_config    = typename template_conditional<needs_complex_slot,
     //                                                      complex_slot,
     //                                                      simple_slot>::template
     //                                                      templ<K,M,NM>;
 
+    using slot_selection = typename std::conditional<
+        packed_selection::is_packed,
+        packed_selection,
+        typename std::conditional<
+            is_key_only_set,
+            set_slot_config<true>,
+            slot_config<sizeof(value_type),
+                        sizeof(key_type),
+                        needs_growing_with_ref_integrity> >::type>::type;
+
     using base_table_config = base_linear_config<
-        typename slot_config<sizeof(value_type),
-                             sizeof(key_type),
-                             needs_growing_with_ref_integrity>::
-            template templ<key_type, mapped_type, needs_marking>,
+        typename slot_selection::template templ<
+            key_type,
+            mapped_type,
+            needs_marking,
+            mods::template is<hmod::inplace_updates>(),
+            mods::template is<hmod::stored_hash>()>,
         HashFct,
         Allocator,
         mods::template is<hmod::circular_map>(),
         mods::template is<hmod::circular_prob>(),
-        !mods::template is<hmod::growable>()>;
+        !mods::template is<hmod::growable>(),
+        mods::template is<hmod::tag_probing>(),
+        mods::template is<hmod::bounded_probing>(),
+        mods::template is<hmod::lookup_filter>(),
+        mods::template is<hmod::stats>()>;
 
     using base_table_type = base_linear<base_table_config>;
 
     template <class P>
-    using workerstrat =
+    using workerstrat = typename std::conditional<
+        mods::template is<hmod::shared_pool>(),
+        wstrat_shared<P>,
         typename std::conditional<!mods::template is<hmod::pool>(),
                                   wstrat_user<P>,
-                                  wstrat_pool<P> >::type;
+                                  wstrat_pool<P> >::type>::type;
     template <class P>
-    using exclstrat =
+    using exclstrat = typename std::conditional<
+        mods::template is<hmod::incremental>(),
+        estrat_incremental<P>,
         typename std::conditional<!mods::template is<hmod::sync>(),
                                   estrat_async<P>,
-                                  estrat_sync<P> >::type;
+                                  estrat_sync<P> >::type>::type;
+
+    // incremental migrations are done by the operations themselves (pool
+    // threads would migrate the whole table at once)
+    static_assert(!mods::template is<hmod::incremental>() ||
+                      !(mods::template is<hmod::sync>() ||
+                        mods::template is<hmod::pool>() ||
+                        mods::template is<hmod::shared_pool>()),
+                  "hmod::incremental cannot be combined with hmod::sync, "
+                  "hmod::pool, or hmod::shared_pool");
+    static_assert(!(mods::template is<hmod::pool>() &&
+                    mods::template is<hmod::shared_pool>()),
+                  "hmod::pool and hmod::shared_pool are exclusive");
+
 
 
+    // the old table of a synchronized migration is freed, finds cannot
+    // read it while the migration is running
+    static_assert(!mods::template is<hmod::nohelp_finds>() ||
+                      !mods::template is<hmod::sync>(),
+                  "hmod::nohelp_finds cannot be combined with hmod::sync");
 
     using table_type = typename std::conditional<
         needs_migration,
-        migration_table<base_table_type, workerstrat, exclstrat>,
+        migration_table<base_table_type,
+                        workerstrat,
+                        exclstrat,
+                        mods::template is<hmod::nohelp_finds>()>,
         base_table_type>::type;
 
 
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * data-structures/table_health.hpp
+ *
+ * Result of base_linear::health(), a (parallel) scan over all slots of a
+ * table. It reports the distribution of cluster lengths and displacements,
+ * the density of deleted slots per block and, for slots with fingerprints
+ * (complex_slot), how often a fingerprint matches a different key. The scan
+ * should be done while the table is quiescent, concurrent updates are not
+ * prevented, but make the results approximate.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <ostream>
+
+namespace growt
+{
+
+struct table_health
+{
+    // log2 buckets: [0], [1], [2,4), [4,8), ..., [2^14,inf)
+    static constexpr size_t log_buckets = 16;
+    // blocks by their fraction of deleted slots: [0,10%), ..., [90%,100%]
+    static constexpr size_t density_buckets = 10;
+
+    size_t capacity   = 0;
+    size_t elements   = 0;
+    size_t tombstones = 0;
+
+    // maximal runs of non-empty slots (deleted slots do not end clusters)
+    size_t clusters    = 0;
+    size_t max_cluster = 0;
+    size_t cluster_hist[log_buckets]{};
+
+    // distance of each element from its home slot (_mapper.map(hash))
+    size_t displacement     = 0;
+    size_t max_displacement = 0;
+    size_t displacement_hist[log_buckets]{};
+
+    size_t block_size           = 0;
+    size_t blocks               = 0;
+    size_t max_block_tombstones = 0;
+    size_t tombstone_hist[density_buckets]{};
+
+    // successful finds compare the fingerprints of all slots between the
+    // home slot and the element, collisions are matches with other keys
+    bool   fingerprints           = false;
+    size_t fingerprint_checks     = 0;
+    size_t fingerprint_collisions = 0;
+
+    static size_t log_bucket(size_t x)
+    {
+        return std::min<size_t>(std::bit_width(x), log_buckets - 1);
+    }
+
+    void add_cluster(size_t length)
+    {
+        ++clusters;
+        max_cluster = std::max(max_cluster, length);
+        ++cluster_hist[log_bucket(length)];
+    }
+    void add_element(size_t disp)
+    {
+        ++elements;
+        displacement += disp;
+        max_displacement = std::max(max_displacement, disp);
+        ++displacement_hist[log_bucket(disp)];
+    }
+    void add_block(size_t slots, size_t deleted)
+    {
+        ++blocks;
+        max_block_tombstones = std::max(max_block_tombstones, deleted);
+        ++tombstone_hist[std::min(density_buckets - 1,
+                                  deleted * density_buckets / slots)];
+    }
+
+    double load() const { return double(elements) / double(capacity); }
+    double effective_load() const
+    {
+        return double(elements + tombstones) / double(capacity);
+    }
+    double average_cluster() const
+    {
+        return (clusters) ? double(elements + tombstones) / double(clusters)
+                          : 0.;
+    }
+    double average_displacement() const
+    {
+        return (elements) ? double(displacement) / double(elements) : 0.;
+    }
+    double fingerprint_collision_rate() const
+    {
+        return (fingerprint_checks) ? double(fingerprint_collisions) /
+                                          double(fingerprint_checks)
+                                    : 0.;
+    }
+
+    // merges the results of two disjoint parts of the same table
+    table_health& operator+=(const table_health& rhs)
+    {
+        elements += rhs.elements;
+        tombstones += rhs.tombstones;
+        clusters += rhs.clusters;
+        max_cluster = std::max(max_cluster, rhs.max_cluster);
+        displacement += rhs.displacement;
+        max_displacement = std::max(max_displacement, rhs.max_displacement);
+        blocks += rhs.blocks;
+        max_block_tombstones =
+            std::max(max_block_tombstones, rhs.max_block_tombstones);
+        fingerprint_checks += rhs.fingerprint_checks;
+        fingerprint_collisions += rhs.fingerprint_collisions;
+        for (size_t i = 0; i < log_buckets; ++i)
+        {
+            cluster_hist[i] += rhs.cluster_hist[i];
+            displacement_hist[i] += rhs.displacement_hist[i];
+        }
+        for (size_t i = 0; i < density_buckets; ++i)
+            tombstone_hist[i] += rhs.tombstone_hist[i];
+        return *this;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const table_health& t)
+{
+    out << "capacity " << t.capacity << " elements " << t.elements
+        << " tombstones " << t.tombstones << " load " << t.load()
+        << " effective_load " << t.effective_load() << "\nclusters "
+        << t.clusters << " avg " << t.average_cluster() << " max "
+        << t.max_cluster << " hist";
+    for (auto h : t.cluster_hist) out << " " << h;
+    out << "\ndisplacement avg " << t.average_displacement() << " max "
+        << t.max_displacement << " hist";
+    for (auto h : t.displacement_hist) out << " " << h;
+    out << "\nblocks " << t.blocks << " (" << t.block_size
+        << " slots) max_tombstones " << t.max_block_tombstones << " hist";
+    for (auto h : t.tombstone_hist) out << " " << h;
+    if (t.fingerprints)
+        out << "\nfingerprint checks " << t.fingerprint_checks
+            << " collisions " << t.fingerprint_collisions << " rate "
+            << t.fingerprint_collision_rate();
+    return out;
+}
+
+} // namespace growt
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ * data-structures/table_stats.hpp
+ *
+ * Online operation statistics of growing tables (hmod::stats). Every handle
+ * counts its own operations (probe lengths, CAS retries, migration work),
+ * only the owning thread writes these counters. migration_table::stats()
+ * sums the counters of all handles without stopping them (counters of
+ * destroyed handles are kept in the registry).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+#include "data-structures/counter_registry.hpp"
+
+namespace growt
+{
+
+template <class T>
+struct basic_table_stats
+{
+    // operations with probe lengths in [0,2), [2,4), ..., [128,inf)
+    static constexpr size_t probe_buckets = 8;
+
+    T inserts{};           // insert, emplace, and insert_batch elements
+    T finds{};             // find and find_batch keys
+    T updates{};           // update variants
+    T insert_or_updates{}; // insert_or_update variants (and batch elements)
+    T erases{};            // erase and erase_if
+    T probes{};            // slots loaded by the operations above
+    T cas_retries{};       // slot accesses that were repeated after a failure
+    T grows{};             // migrations started
+    T help_grows{};        // migrations joined (or waited for)
+    T migrated_blocks{};   // blocks migrated by the handle itself
+    T migration_ns{};      // time spent in grow and help_grow
+    T probe_histogram[probe_buckets]{};
+
+    size_t operations() const
+    {
+        return inserts + finds + updates + insert_or_updates + erases;
+    }
+    double average_probes() const
+    {
+        size_t ops = operations();
+        return (ops) ? double(probes) / double(ops) : 0.;
+    }
+};
+
+// snapshot returned by stats()
+using table_stats = basic_table_stats<size_t>;
+// counters of one handle (aligned, they are written by different threads)
+struct alignas(64) stats_counters : basic_table_stats<std::atomic_size_t>
+{
+};
+
+// applies f to all pairs of corresponding counters
+template <class A, class B, class F>
+inline void zip_counters(A& a, B& b, F&& f)
+{
+    f(a.inserts, b.inserts);
+    f(a.finds, b.finds);
+    f(a.updates, b.updates);
+    f(a.insert_or_updates, b.insert_or_updates);
+    f(a.erases, b.erases);
+    f(a.probes, b.probes);
+    f(a.cas_retries, b.cas_retries);
+    f(a.grows, b.grows);
+    f(a.help_grows, b.help_grows);
+    f(a.migrated_blocks, b.migrated_blocks);
+    f(a.migration_ns, b.migration_ns);
+    for (size_t i = 0; i < table_stats::probe_buckets; ++i)
+        f(a.probe_histogram[i], b.probe_histogram[i]);
+}
+
+inline std::ostream& operator<<(std::ostream& out, const table_stats& s)
+{
+    out << "ins " << s.inserts << " find " << s.finds << " upd " << s.updates
+        << " ins_upd " << s.insert_or_updates << " erase " << s.erases
+        << " avg_probes " << s.average_probes() << " cas_retries "
+        << s.cas_retries << " grows " << s.grows << " help_grows "
+        << s.help_grows << " blocks " << s.migrated_blocks << " mig_ms "
+        << double(s.migration_ns) / 1000000. << " probe_hist";
+    for (auto h : s.probe_histogram) out << " " << h;
+    return out;
+}
+
+
+
+// THREAD LOCAL COUNTERS *******************************************************
+// the base tables do not know the handle that calls them, they count into
+// these thread local counters. Handles read them before and after each
+// operation (no reset, the thread might use multiple handles).
+struct thread_stats
+{
+    size_t probes          = 0;
+    size_t cas_retries     = 0;
+    size_t migrated_blocks = 0;
+};
+
+inline thread_local thread_stats this_thread_stats;
+
+
+
+// REGISTRY (STORED AT THE GLOBAL TABLE OBJECT) ********************************
+struct fold_stats
+{
+    void operator()(table_stats& total, const stats_counters& counters) const
+    {
+        zip_counters(total, counters,
+                     [](size_t& r, const std::atomic_size_t& c) {
+                         r += c.load(std::memory_order_relaxed);
+                     });
+    }
+};
+
+using stats_registry =
+    counter_registry<stats_counters, table_stats, fold_stats>;
+
+
+
+// HANDLE LOCAL PART ***********************************************************
+template <bool enabled>
+class handle_stats
+{
+  public:
+    using counter_type = std::atomic_size_t stats_counters::*;
+
+    handle_stats(stats_registry& registry)
+        : _registry(&registry), _counters(registry.add()), _depth(0)
+    {
+    }
+
+    handle_stats(const handle_stats&)            = delete;
+    handle_stats& operator=(const handle_stats&) = delete;
+
+    handle_stats(handle_stats&& rhs) noexcept
+        : _registry(rhs._registry), _counters(rhs._counters), _depth(0)
+    {
+        rhs._counters = nullptr;
+    }
+    handle_stats& operator=(handle_stats&& rhs) = delete;
+
+    ~handle_stats()
+    {
+        if (_counters) _registry->remove(_counters);
+    }
+
+    // counts n operations of one type, their probes and retries are the
+    // difference of the thread local counters (nested scopes, e.g. a retry
+    // through the public function, are ignored)
+    class [[nodiscard]] op_scope
+    {
+      public:
+        op_scope(handle_stats& s, counter_type counter, size_t n)
+            : _stats(s), _outer(s._depth++ == 0), _counter(counter), _n(n),
+              _start(this_thread_stats)
+        {
+        }
+        op_scope(const op_scope&)            = delete;
+        op_scope& operator=(const op_scope&) = delete;
+        ~op_scope()
+        {
+            --_stats._depth;
+            if (!_outer) return;
+            auto& c      = *_stats._counters;
+            auto  probes = this_thread_stats.probes - _start.probes;
+            add_owned(c.*_counter, _n);
+            add_owned(c.probes, probes);
+            add_owned(c.cas_retries,
+                      this_thread_stats.cas_retries - _start.cas_retries);
+            // batches are recorded with their average probe length
+            size_t per_op = (_n == 1) ? probes : (_n) ? probes / _n : 0;
+            size_t bucket = std::min<size_t>(std::bit_width(per_op >> 1),
+                                             table_stats::probe_buckets - 1);
+            add_owned(c.probe_histogram[bucket], _n);
+        }
+
+      private:
+        handle_stats& _stats;
+        bool          _outer;
+        counter_type  _counter;
+        size_t        _n;
+        thread_stats  _start;
+    };
+
+    // measures a grow/help_grow call, the slots loaded during the migration
+    // are not counted as probes of the current operation
+    class [[nodiscard]] migration_scope
+    {
+      public:
+        migration_scope(handle_stats& s, counter_type counter)
+            : _stats(s), _counter(counter), _start(this_thread_stats),
+              _time(std::chrono::steady_clock::now())
+        {
+        }
+        migration_scope(const migration_scope&)            = delete;
+        migration_scope& operator=(const migration_scope&) = delete;
+        ~migration_scope()
+        {
+            auto  dur = std::chrono::steady_clock::now() - _time;
+            auto& c   = *_stats._counters;
+            add_owned(c.*_counter, 1);
+            add_owned(c.migrated_blocks, this_thread_stats.migrated_blocks -
+                                             _start.migrated_blocks);
+            add_owned(c.migration_ns,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(dur)
+                          .count());
+            this_thread_stats.probes      = _start.probes;
+            this_thread_stats.cas_retries = _start.cas_retries;
+        }
+
+      private:
+        handle_stats&                         _stats;
+        counter_type                          _counter;
+        thread_stats                          _start;
+        std::chrono::steady_clock::time_point _time;
+    };
+
+    op_scope count_op(counter_type counter, size_t n = 1)
+    {
+        return op_scope(*this, counter, n);
+    }
+    migration_scope count_migration(counter_type counter)
+    {
+        return migration_scope(*this, counter);
+    }
+
+  private:
+    stats_registry* _registry;
+    stats_counters* _counters;
+    size_t          _depth;
+};
+
+// without hmod::stats, nothing is counted (stats() returns zeroes)
+template <>
+class handle_stats<false>
+{
+  public:
+    using counter_type = std::atomic_size_t stats_counters::*;
+
+    struct [[nodiscard]] scope
+    {
+        ~scope() {}
+    };
+
+    handle_stats(stats_registry&) {}
+
+    scope count_op(counter_type, size_t = 1) { return scope(); }
+    scope count_migration(counter_type) { return scope(); }
+};
+
+} // namespace growt
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * data-structures/tag_group.hpp
+ *
+ * Helper for the optional control-byte layout of base_linear
+ * (hmod::tag_probing). Every slot gets a one byte tag (0 = empty, otherwise
+ * 0x80 | 7 hash bits). A group of consecutive tags is compared at once using
+ * SSE2/AVX2, such that only slots with a matching tag have to be loaded.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace growt
+{
+
+class tag_group
+{
+  public:
+    using tag_type        = uint8_t;
+    using atomic_tag_type = std::atomic<tag_type>;
+    using mask_type       = uint32_t;
+
+    static_assert(sizeof(atomic_tag_type) == 1,
+                  "tag_group needs single byte atomics!");
+
+#if defined(__AVX2__)
+    static constexpr size_t width = 32;
+#elif defined(__SSE2__)
+    static constexpr size_t width = 16;
+#else
+    static constexpr size_t width = 8;
+#endif
+
+    static constexpr tag_type empty_tag = 0;
+
+    // hash bits that are not used for the mapping should be used for the tag
+    // (i.e. the lowest bits for linear mapping, the highest for cyclic)
+    template <bool CyclicMapping>
+    static inline tag_type make_tag(size_t hash)
+    {
+        if constexpr (CyclicMapping)
+            return tag_type(0x80 | (hash >> 57));
+        else
+            return tag_type(0x80 | (hash & 0x7f));
+    }
+
+    // The tags are read with one (unaligned) vector load, while other threads
+    // may store tags. Formally, this is a data race on the atomic bytes, it is
+    // intended and benign: on x86, the load gives the same guarantees as the
+    // individual relaxed byte loads (each byte is either old or new). The
+    // signal fences keep the compiler from moving the load across the
+    // surrounding atomic operations.
+    explicit tag_group(const atomic_tag_type* pos)
+    {
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        __builtin_memcpy(&_data, reinterpret_cast<const void*>(pos), width);
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+    }
+
+    // bit i is set iff tag i equals t
+    inline mask_type match(tag_type t) const { return match_intern(t); }
+    // bit i is set iff slot i is (probably) empty
+    inline mask_type match_empty() const { return match_intern(empty_tag); }
+
+  private:
+#if defined(__AVX2__)
+    __m256i _data;
+
+    inline mask_type match_intern(tag_type t) const
+    {
+        auto cmp = _mm256_cmpeq_epi8(_data, _mm256_set1_epi8(char(t)));
+        return mask_type(_mm256_movemask_epi8(cmp));
+    }
+#elif defined(__SSE2__)
+    __m128i _data;
+
+    inline mask_type match_intern(tag_type t) const
+    {
+        auto cmp = _mm_cmpeq_epi8(_data, _mm_set1_epi8(char(t)));
+        return mask_type(_mm_movemask_epi8(cmp));
+    }
+#else
+    uint64_t _data;
+
+    inline mask_type match_intern(tag_type t) const
+    {
+        mask_type result = 0;
+        for (size_t i = 0; i < width; ++i)
+            if (tag_type(_data >> (8 * i)) == t) result |= mask_type(1) << i;
+        return result;
+    }
+#endif
+};
+
+} // namespace growt
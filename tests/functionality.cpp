@@ -9,7 +9,12 @@
  *
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
+#include <algorithm>
 #include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "utils/command_line_parser.hpp"
 #include "utils/default_hash.hpp"
@@ -17,6 +22,11 @@
 #include "utils/pin_thread.hpp"
 #include "utils/thread_coordination.hpp"
 
+#include "allocator/slaballocator.hpp"
+
+#include "data-structures/hash_batch.hpp"
+#include "data-structures/migration_scheduler.hpp"
+#include "data-structures/migration_trace.hpp"
 #include "data-structures/returnelement.hpp"
 
 #include "example/update_fcts.hpp"
@@ -36,6 +46,83 @@ using fun_config_complex = table_config<std::string, std::atomic_size_t,
                                         allocator_type, hmod::ref_integrity>;
 using simple_table_type  = typename fun_config_simple ::table_type;
 using complex_table_type = typename fun_config_complex::table_type;
+// counts operations and migrations (see table_stats.hpp)
+using fun_config_stats =
+    table_config<size_t, size_t, utils_tm::hash_tm::default_hash,
+                 allocator_type, hmod::stats>;
+using stats_table_type = typename fun_config_stats::table_type;
+// string keys are stored out of line (complex_slot, see epoch_reclamation.hpp)
+using fun_config_string =
+    table_config<std::string, size_t, utils_tm::hash_tm::default_hash,
+                 allocator_type>;
+using string_table_type = typename fun_config_string::table_type;
+// the out-of-line mapped values are updated in place (not copy-on-write)
+using fun_config_inplace =
+    table_config<std::string, size_t, utils_tm::hash_tm::default_hash,
+                 allocator_type, hmod::inplace_updates>;
+using inplace_table_type = typename fun_config_inplace::table_type;
+// the fingerprint holds the hash bits that are not implied by the position
+// (complex_slot with hmod::stored_hash, hmod::incremental cannot use it,
+// those tests use asynchronous migrations instead)
+constexpr hmod stored_hash_estrat =
+    (estrat == hmod::incremental) ? hmod::neutral : estrat;
+using fun_config_stored_hash =
+    growt::table_config<std::string, size_t, utils_tm::hash_tm::default_hash,
+                        allocator_type, dynamic, stored_hash_estrat, wstrat,
+                        cmap, cprob, tags, bound, hmod::stored_hash>;
+using stored_hash_table_type = typename fun_config_stored_hash::table_type;
+
+// hash sets (void mapped type), unsigned integral keys use key_only_slot
+using fun_config_set =
+    table_config<size_t, void, utils_tm::hash_tm::default_hash,
+                 allocator_type>;
+using set_table_type = typename fun_config_set::table_type;
+using fun_config_string_set =
+    table_config<std::string, void, utils_tm::hash_tm::default_hash,
+                 allocator_type>;
+using string_set_table_type = typename fun_config_string_set::table_type;
+// finds consult a blocked bloom filter before probing (lookup filter)
+using fun_config_filter =
+    table_config<size_t, size_t, utils_tm::hash_tm::default_hash,
+                 allocator_type, hmod::lookup_filter>;
+using filter_table_type = typename fun_config_filter::table_type;
+// finds neither help with nor wait for migrations (not with hmod::sync)
+constexpr hmod nohelp =
+    (estrat == hmod::sync) ? hmod::neutral : hmod::nohelp_finds;
+using fun_config_nohelp =
+    table_config<size_t, size_t, utils_tm::hash_tm::default_hash,
+                 allocator_type, nohelp>;
+using nohelp_table_type = typename fun_config_nohelp::table_type;
+// 40 bit keys and 23 bit values share one word (packed_slot)
+using fun_config_packed =
+    table_config<growt::packed_bits<40>, growt::packed_bits<23>,
+                 utils_tm::hash_tm::default_hash, allocator_type>;
+using packed_table_type = typename fun_config_packed::table_type;
+// 40 bit keys, the slot only stores the remainder of their hash (the table
+// replaces shrink targets that cannot store a displacement, see base_linear)
+using fun_config_quotient =
+    table_config<growt::quotient_bits<40>, growt::packed_bits<23>,
+                 growt::quotient_hash<40>, allocator_type>;
+using quotient_table_type = typename fun_config_quotient::table_type;
+// the hash functor has a batched version (migrations hash blocks of keys,
+// see hash_batch.hpp)
+using fun_config_batch_hash =
+    table_config<size_t, size_t, growt::multiply_shift_hash, allocator_type>;
+using batch_hash_table_type = typename fun_config_batch_hash::table_type;
+
+// the low 16 bits of all hashes are equal, i.e., all complex_slot
+// fingerprints collide (homes are computed from the high bits)
+struct fingerprint_collision_hash
+{
+    size_t operator()(const std::string& k) const
+    {
+        return utils_tm::hash_tm::default_hash{}(k) & ~size_t(0xffff);
+    }
+};
+using fun_config_collision =
+    table_config<std::string, size_t, fingerprint_collision_hash,
+                 allocator_type>;
+using collision_table_type = typename fun_config_collision::table_type;
 
 alignas(64) static simple_table_type simple_table   = simple_table_type(0);
 alignas(64) static complex_table_type complex_table = complex_table_type(0);
@@ -58,7 +145,10 @@ void perform_test(TType& t, const std::string& name,
           << std::endl;
     t.synchronized(f, std::forward<Args>(args)...);
     t.out << "  " << name << " DONE" << std::flush;
-    auto err = errors.exchange(0, std::memory_order_relaxed);
+    // only the main thread reports (and resets) the errors
+    size_t err = 0;
+    if constexpr (TType::is_main)
+        err = errors.exchange(0, std::memory_order_relaxed);
     if (!err)
         t.out << otm::color::green << "-> SUCCESSFUL" << otm::color::reset
               << std::endl
@@ -69,6 +159,31 @@ void perform_test(TType& t, const std::string& name,
               << std::endl;
 }
 
+// the tables of the feature tests below are created by the main thread
+// and shared by all threads (handles have to be destroyed before the table)
+template <class TableType> static TableType* feature_table = nullptr;
+
+template <class TableType, class ThreadType, class... Args>
+TableType& create_table(ThreadType& t, Args... args)
+{
+    t.synchronize();
+    if constexpr (ThreadType::is_main)
+        feature_table<TableType> = new TableType(args...);
+    t.synchronize();
+    return *feature_table<TableType>;
+}
+
+template <class TableType, class ThreadType> void destroy_table(ThreadType& t)
+{
+    t.synchronize();
+    if constexpr (ThreadType::is_main)
+    {
+        delete feature_table<TableType>;
+        feature_table<TableType> = nullptr;
+    }
+    t.synchronize();
+}
+
 struct inc_test
 {
     using mapped_type = uint64_t;
@@ -444,6 +559,7 @@ void operator_test(ThreadType& t, HashType& hash, size_t n)
                          auto res = hash[keys[i]];
                          if (res != i) err++;
                      });
+                     errors.fetch_add(err, std::memory_order_relaxed);
                      return 0;
                  });
 }
@@ -479,6 +595,1175 @@ void range_iterator_test(ThreadType& t, HashType& hash,
         });
 }
 
+// INPUT  full 2*n elements (i)
+// OUTPUT full 2*n elements (i+1)
+template <class ThreadType, class HashType>
+void batch_test(ThreadType& t, HashType& hash, size_t n)
+{
+    using batch_element_type = typename HashType::batch_element_type;
+
+    t.out << otm::color::bblue << "BATCH TEST" << otm::color::reset
+          << std::endl;
+    perform_test(t, "FIND BATCH", "look for all 2*n elements in batches",
+                 [&]() {
+                     size_t err = 0;
+                     ttm::execute_blockwise_parallel(
+                         current_block, 2 * n, [&](size_t s, size_t e) {
+                             auto found = hash.find_batch(
+                                 std::span<const uint64_t>(keys + s, e - s),
+                                 [&](size_t j, auto it) {
+                                     if (it == hash.end() ||
+                                         (*it).second != s + j)
+                                         err++;
+                                 });
+                             if (found != e - s) err++;
+                         });
+                     errors.fetch_add(err, std::memory_order_relaxed);
+                     return 0;
+                 });
+
+    perform_test(t, "+ERASE", "delete the second n elements", [&]() {
+        size_t err = 0;
+        ttm::execute_parallel(current_block, n, [&](size_t i) {
+            if (hash.erase(keys[n + i]) != 1) err++;
+        });
+        errors.fetch_add(err, std::memory_order_relaxed);
+        return 0;
+    });
+
+    perform_test(
+        t, "INSERT BATCH",
+        "insert all 2*n elements in batches (only the second n succeed)",
+        [&]() {
+            size_t                          err = 0;
+            std::vector<batch_element_type> elements;
+            ttm::execute_blockwise_parallel(
+                current_block, 2 * n, [&](size_t s, size_t e) {
+                    elements.clear();
+                    for (size_t i = s; i < e; ++i)
+                        elements.emplace_back(keys[i], i);
+                    auto   ins      = hash.insert_batch(elements);
+                    size_t expected = e - std::max(s, std::min(e, n));
+                    if (ins != expected) err++;
+                });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+    perform_test(t, "INSERT OR UPDATE BATCH",
+                 "increment all 2*n elements in batches", [&]() {
+                     size_t                          err    = 0;
+                     bool                            atomic = false;
+                     std::vector<batch_element_type> elements;
+                     ttm::execute_blockwise_parallel(
+                         current_block, 2 * n, [&](size_t s, size_t e) {
+                             elements.clear();
+                             for (size_t i = s; i < e; ++i)
+                                 elements.emplace_back(keys[i], 0);
+                             auto ins = hash.insert_or_update_batch(
+                                 elements, inc_test(), atomic);
+                             if (ins != 0) err++;
+                         });
+                     errors.fetch_add(err, std::memory_order_relaxed);
+                     return 0;
+                 });
+
+    perform_test(t, "CHECK BATCH", "find lookup all keys check data", [&]() {
+        size_t err = 0;
+        ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+            auto it = hash.find(keys[i]);
+            if (it == hash.end() || (*it).second != i + 1) err++;
+        });
+        errors.fetch_add(err, std::memory_order_relaxed);
+        return 0;
+    });
+}
+
+// INPUT  nothing (own table, built from 2*n elements)
+// OUTPUT nothing
+template <class ThreadType> void build_test(ThreadType& t, size_t n)
+{
+    using batch_element_type = typename simple_table_type::batch_element_type;
+
+    t.out << otm::color::bblue << "BUILD TEST" << otm::color::reset
+          << std::endl;
+    t.synchronize();
+    if constexpr (ThreadType::is_main)
+    {
+        // the first n elements are given twice (they are inserted once)
+        std::vector<batch_element_type> elements;
+        for (size_t i = 0; i < 3 * n; ++i)
+            elements.emplace_back(keys[i % (2 * n)], i % (2 * n));
+        feature_table<simple_table_type> = new simple_table_type(
+            simple_table_type::build_from(elements, 4));
+    }
+    t.synchronize();
+    auto& table = *feature_table<simple_table_type>;
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "CHECK BUILD", "find all 2*n elements", [&]() {
+            size_t err = 0;
+            if constexpr (ThreadType::is_main)
+                if (table.size_exact() != 2 * n) err++;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto it = hash.find(keys[i]);
+                if (it == hash.end() || (*it).second != i) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "INSERTION", "reinsert all 2*n elements (no success)",
+                     [&]() {
+                         size_t err = 0;
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 if (hash.insert(keys[i], i).second) err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+    }
+    destroy_table<simple_table_type>(t);
+}
+
+// INPUT  nothing (own table with a low-water mark)
+// OUTPUT nothing
+template <class ThreadType> void shrink_test(ThreadType& t, size_t n)
+{
+    constexpr double min_fill = 0.05;
+    static size_t    grown_capacity;
+
+    t.out << otm::color::bblue << "SHRINK TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<simple_table_type>(t, 0, min_fill);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting 2*n elements", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(keys[i], i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        t.synchronize();
+        if constexpr (ThreadType::is_main) grown_capacity = hash.capacity();
+        t.synchronize();
+
+        perform_test(t, "+ERASE",
+                     "delete all but every 64th element (below the low-water "
+                     "mark)",
+                     [&]() {
+                         size_t err = 0;
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 if (i % 64 && hash.erase(keys[i]) != 1) err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(
+            t, "CHECK SHRINK",
+            "iterate and find all keys, the table has to be smaller", [&]() {
+                size_t err = 0;
+                if constexpr (ThreadType::is_main)
+                {
+                    size_t count = 0;
+                    for (auto it = hash.begin(); it != hash.end(); ++it)
+                    {
+                        if ((*it).second % 64) err++;
+                        ++count;
+                    }
+                    if (count != (2 * n + 63) / 64) err++;
+
+                    // the low-water mark was crossed, if the elements
+                    // filled the grown table above it
+                    auto low = double(grown_capacity) * min_fill;
+                    if (double(2 * n) > low && double(2 * n / 64) < low &&
+                        hash.capacity() >= grown_capacity)
+                        err++;
+                }
+                ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                    auto it = hash.find(keys[i]);
+                    if (i % 64 == 0 && (it == hash.end() || (*it).second != i))
+                        err++;
+                    if (i % 64 && it != hash.end()) err++;
+                });
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+
+        perform_test(t, "REGROWING",
+                     "reinsert the deleted elements into the shrunk table",
+                     [&]() {
+                         size_t err = 0;
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 auto ins_ret = hash.insert(keys[i], i);
+                                 if (ins_ret.second != bool(i % 64)) err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(t, "CHECK REGROWING", "find all 2*n elements", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto it = hash.find(keys[i]);
+                if (it == hash.end() || (*it).second != i) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<simple_table_type>(t);
+}
+
+// INPUT  nothing (own table that is large enough for all live elements)
+// OUTPUT nothing
+template <class ThreadType> void purge_test(ThreadType& t, size_t n)
+{
+    constexpr size_t rounds = 4;
+    static size_t    initial_capacity;
+
+    t.out << otm::color::bblue << "PURGE TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<stats_table_type>(t, n);
+    {
+        auto hash = table.get_handle();
+        t.synchronize();
+        if constexpr (ThreadType::is_main)
+            initial_capacity = hash.capacity();
+        t.synchronize();
+
+        // at most 2*n/8 elements are live, the deleted dummies trigger
+        // migrations that keep the size (in place with hmod::sync)
+        perform_test(t, "CHURN",
+                     "insert 2*n elements and delete 7/8 of them (repeatedly)",
+                     [&]() {
+                         size_t err = 0;
+                         for (size_t r = 0; r < rounds; ++r)
+                         {
+                             t.synchronize();
+                             if constexpr (ThreadType::is_main)
+                                 current_block.store(0);
+                             t.synchronize();
+                             ttm::execute_parallel(
+                                 current_block, 2 * n, [&](size_t i) {
+                                     auto ins = hash.insert(keys[i], i).second;
+                                     if (ins != (r == 0 || i % 8)) err++;
+                                     if (hash.find(keys[i]) == hash.end())
+                                         err++;
+                                     if (i % 8 && hash.erase(keys[i]) != 1)
+                                         err++;
+                                 });
+                         }
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(
+            t, "CHECK PURGE",
+            "find all keys, the capacity has to be unchanged", [&]() {
+                size_t err = 0;
+                if constexpr (ThreadType::is_main)
+                {
+                    if (hash.capacity() != initial_capacity) err++;
+                    // the growing threshold was passed at least once
+                    size_t insertions =
+                        2 * n + (rounds - 1) * (2 * n - (2 * n + 7) / 8);
+                    auto stats = table.stats();
+                    if (insertions > initial_capacity && stats.grows == 0)
+                        err++;
+                    if (table.size_exact() != (2 * n + 7) / 8) err++;
+                    // each round calls insert and find for all 2*n keys
+                    // and erase for 7/8 of them (every find loads a slot)
+                    if (stats.inserts != rounds * 2 * n) err++;
+                    if (stats.finds != rounds * 2 * n) err++;
+                    if (stats.erases != rounds * (2 * n - (2 * n + 7) / 8))
+                        err++;
+                    if (stats.updates || stats.insert_or_updates) err++;
+                    if (stats.probes < stats.finds) err++;
+                }
+                // the statistics are read before the finds below
+                t.synchronize();
+                ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                    auto it = hash.find(keys[i]);
+                    if (i % 8 == 0 && (it == hash.end() || (*it).second != i))
+                        err++;
+                    if (i % 8 && it != hash.end()) err++;
+                });
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+    }
+    destroy_table<stats_table_type>(t);
+}
+
+// INPUT  nothing (own table, it grows while the elements are inserted)
+// OUTPUT nothing
+template <class ThreadType> void trace_test(ThreadType& t, size_t n)
+{
+    static bool grown;
+
+    t.out << otm::color::bblue << "TRACE TEST" << otm::color::reset
+          << std::endl;
+    t.synchronize();
+    if constexpr (ThreadType::is_main) growt::clear_trace();
+    auto& table = create_table<simple_table_type>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        // tables have a minimum size, i.e., small inputs do not grow
+        size_t initial_capacity = hash.capacity();
+        perform_test(t, "+INSERTION", "inserting 2*n keys (growing)", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(keys[i], i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+        if constexpr (ThreadType::is_main)
+            grown = hash.capacity() != initial_capacity;
+    }
+    destroy_table<simple_table_type>(t);
+
+    // without -DGROWT_TRACE nothing is recorded or written
+    perform_test(t, "CHECK TRACE", "dump the recorded growing steps", [&]() {
+        size_t err = 0;
+        if constexpr (ThreadType::is_main)
+        {
+            // quotes and backslashes in thread names have to be escaped
+            growt::trace_thread_name("main \"0\"\\");
+            std::stringstream out;
+            growt::dump_trace(out);
+            auto trace = out.str();
+            if constexpr (growt::trace_enabled)
+            {
+                if (trace.rfind("{\"traceEvents\":[", 0) != 0) err++;
+                if (trace.find("{\"name\":\"main \\\"0\\\"\\\\\"}") ==
+                    std::string::npos)
+                    err++;
+                if (grown &&
+                    trace.find("\"name\":\"grow\"") == std::string::npos)
+                    err++;
+                if (trace.find("\"displayTimeUnit\":\"ns\"}") ==
+                    std::string::npos)
+                    err++;
+            }
+            else if (!trace.empty())
+                err++;
+            growt::clear_trace();
+        }
+        errors.fetch_add(err, std::memory_order_relaxed);
+        return 0;
+    });
+}
+
+// INPUT  nothing (own table, small until it grew)
+// OUTPUT nothing
+template <class ThreadType> void hash_batch_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "HASH BATCH TEST" << otm::color::reset
+          << std::endl;
+    // each block is hashed in batches of 1 to 67 keys, i.e., the
+    // vectorized/interleaved loops and the remainder loops are both used
+    auto check = [&](const auto& hf) {
+        size_t              err = 0;
+        std::vector<size_t> hashes;
+        ttm::execute_blockwise_parallel(
+            current_block, 2 * n, [&](size_t s, size_t e) {
+                hashes.resize(e - s);
+                for (size_t b = s, len = 1; b < e; b += len, len = len % 67 + 1)
+                    growt::hash_batch(hf, keys + b, std::min(len, e - b),
+                                      hashes.data() + (b - s));
+                for (size_t i = s; i < e; ++i)
+                    if (hashes[i - s] != hf(keys[i])) err++;
+            });
+        errors.fetch_add(err, std::memory_order_relaxed);
+        return 0;
+    };
+
+    perform_test(t, "MULTIPLY SHIFT", "batch hashes equal single hashes",
+                 [&]() { return check(growt::multiply_shift_hash{}); });
+#if defined(__SSE4_2__)
+    perform_test(t, "CRC32C", "batch hashes equal single hashes",
+                 [&]() { return check(growt::crc32c_hash{}); });
+#endif
+
+    // the small table grows multiple times, i.e., the elements are moved by
+    // the batched migration loop
+    auto& table = create_table<batch_hash_table_type>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting 2*n keys (migrations)", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(keys[i], i + 1).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (i % 2 && hash.erase(keys[i]) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "CHECK MIGRATED", "find all keys check data", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto it = hash.find(keys[i]);
+                if (i % 2 == 0 && (it == hash.end() || (*it).second != i + 1))
+                    err++;
+                if (i % 2 && it != hash.end()) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<batch_hash_table_type>(t);
+}
+
+// shared by all threads (function statics would differ between the
+// instantiations for the main and the other threads)
+alignas(64) static growt::migration_scheduler* scheduler;
+alignas(64) static std::atomic_size_t*         taken;
+
+// INPUT  nothing (own scheduler, without a table)
+// OUTPUT nothing
+template <class ThreadType> void scheduler_test(ThreadType& t, size_t n)
+{
+    // more pools than nodes, i.e., helpers take chunks from the pools of
+    // other partitions and steal from each other
+    constexpr size_t partitions = 4;
+    constexpr size_t block_size = growt::migration_scheduler::block_size;
+
+    // the last block is not full
+    const size_t slots  = 2 * n + 123;
+    const size_t blocks = (slots + block_size - 1) / block_size;
+
+    t.out << otm::color::bblue << "SCHEDULER TEST" << otm::color::reset
+          << std::endl;
+    t.synchronize();
+    if constexpr (ThreadType::is_main)
+    {
+        scheduler = new growt::migration_scheduler(slots, partitions);
+        taken     = new std::atomic_size_t[blocks]{};
+    }
+    t.synchronize();
+
+    for (size_t round = 1; round <= 2; ++round)
+    {
+        perform_test(t, "TAKE BLOCKS", "all threads take blocks", [&]() {
+            size_t err = 0, s, e;
+            growt::migration_scheduler::helper_type helper(*scheduler);
+            while (helper.next(s, e))
+            {
+                if (s % block_size || e <= s || e > slots ||
+                    e != std::min(s + block_size, slots))
+                    err++;
+                taken[s / block_size].fetch_add(1, std::memory_order_relaxed);
+            }
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "CHECK BLOCKS", "every block was taken once", [&]() {
+            size_t err = 0;
+            if constexpr (ThreadType::is_main)
+            {
+                if (!scheduler->started()) err++;
+                for (size_t b = 0; b < blocks; ++b)
+                    if (taken[b].load(std::memory_order_relaxed) != round)
+                        err++;
+                // the blocks are handed out again in the next round
+                scheduler->reset();
+            }
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+
+    t.synchronize();
+    if constexpr (ThreadType::is_main)
+    {
+        delete scheduler;
+        delete[] taken;
+    }
+    t.synchronize();
+}
+
+// INPUT  nothing (own table, small until the reservation)
+// OUTPUT nothing
+template <class ThreadType> void reserve_test(ThreadType& t, size_t n)
+{
+    static size_t reserved_capacity;
+    static size_t reserved_grows;
+
+    t.out << otm::color::bblue << "RESERVE TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<stats_table_type>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "RESERVE", "reserve space for 2*n elements", [&]() {
+            size_t err = 0;
+            // concurrent reservations are allowed (only one migration)
+            hash.reserve(2 * n);
+            if (hash.capacity() < 2 * n) err++;
+            t.synchronize();
+            if constexpr (ThreadType::is_main)
+            {
+                reserved_capacity = hash.capacity();
+                reserved_grows    = table.stats().grows;
+            }
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+INSERTION", "inserting 2*n keys (without growing)",
+                     [&]() {
+                         size_t err = 0;
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 if (!hash.insert(keys[i], i).second) err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(t, "CHECK RESERVE",
+                     "find all keys, the capacity has to be unchanged", [&]() {
+                         size_t err = 0;
+                         if constexpr (ThreadType::is_main)
+                         {
+                             auto stats = table.stats();
+                             if (hash.capacity() != reserved_capacity) err++;
+                             if (stats.grows != reserved_grows) err++;
+                             if (stats.inserts != 2 * n || stats.finds) err++;
+                         }
+                         // the statistics are read before the finds below
+                         t.synchronize();
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 auto it = hash.find(keys[i]);
+                                 if (it == hash.end() || (*it).second != i)
+                                     err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+    }
+    destroy_table<stats_table_type>(t);
+}
+
+// INPUT  nothing (own tables, without migrations)
+// OUTPUT nothing
+template <class ThreadType> void health_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "HEALTH TEST" << otm::color::reset
+          << std::endl;
+    // the table is large enough for 2*n elements (no migration)
+    auto& table = create_table<simple_table_type>(t, 2 * n);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting 2*n keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(keys[i], i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (i % 2 && hash.erase(keys[i]) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        // there was no migration, i.e., all erased elements are tombstones
+        perform_test(
+            t, "CHECK HEALTH", "sequential and parallel scan of all slots",
+            [&]() {
+                size_t err = 0;
+                if constexpr (ThreadType::is_main)
+                {
+                    auto seq = hash.health();
+                    auto par = hash.health(4, 1000);
+                    for (const auto& h : {seq, par})
+                    {
+                        size_t clusters = 0, elements = 0, blocks = 0;
+                        for (auto c : h.cluster_hist) clusters += c;
+                        for (auto d : h.displacement_hist) elements += d;
+                        for (auto b : h.tombstone_hist) blocks += b;
+                        if (h.capacity != hash.capacity()) err++;
+                        if (h.elements != n || h.tombstones != n) err++;
+                        if (clusters != h.clusters || elements != n) err++;
+                        if (blocks != h.blocks) err++;
+                    }
+                    if (seq.clusters != par.clusters ||
+                        seq.max_cluster != par.max_cluster ||
+                        seq.displacement != par.displacement)
+                        err++;
+                }
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+    }
+    destroy_table<simple_table_type>(t);
+
+    if constexpr (cmap == hmod::circular_map)
+    {
+        // the circular mapping uses the fingerprint bits as home slot
+        t.out << "  fingerprints skipped (circular mapping)" << std::endl
+              << std::endl;
+        return;
+    }
+
+    auto& ctable = create_table<collision_table_type>(t, n);
+    {
+        auto hash = ctable.get_handle();
+        perform_test(t, "+INSERTION", "inserting n string keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (!hash.insert(std::to_string(keys[i]), i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        // all slots between the home slot and an element hold elements with
+        // the same fingerprint, i.e., each check is a collision
+        perform_test(
+            t, "CHECK FINGERPRINTS", "scan for fingerprint collisions",
+            [&]() {
+                size_t err = 0;
+                if constexpr (ThreadType::is_main)
+                {
+                    auto h = hash.health(4, 1000);
+                    if (!h.fingerprints || h.elements != n) err++;
+                    if (!h.fingerprint_collisions) err++;
+                    if (h.fingerprint_collisions != h.fingerprint_checks)
+                        err++;
+                }
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+    }
+    destroy_table<collision_table_type>(t);
+}
+
+// the allocator type and the chunks are shared by all threads
+struct slab_item
+{
+    char data[64];
+};
+constexpr size_t slab_bytes    = 1 << 16;
+constexpr size_t slab_per_slab = slab_bytes / sizeof(slab_item);
+constexpr size_t slab_items    = 4 * slab_per_slab;
+using slab_allocator_type = growt::SlabAllocator<slab_item, slab_bytes>;
+
+alignas(64) static slab_item*         slab_chunks[slab_items];
+alignas(64) static std::atomic_size_t slab_consumers;
+
+// INPUT  nothing (own allocator type)
+// OUTPUT nothing
+template <class ThreadType> void slab_test(ThreadType& t)
+{
+    // the main thread only allocates, the other threads only free, i.e.,
+    // their free lists have to reach the main thread through the orphans
+    constexpr size_t per_slab  = slab_per_slab;
+    constexpr size_t rounds    = 128;
+    constexpr size_t m         = slab_items;
+    using allocator            = slab_allocator_type;
+    auto&            items     = slab_chunks;
+    auto&            consumers = slab_consumers;
+
+    t.out << otm::color::bblue << "SLAB TEST" << otm::color::reset
+          << std::endl;
+    t.synchronize();
+    if constexpr (ThreadType::is_main) consumers.store(0);
+    t.synchronize();
+    if constexpr (!ThreadType::is_main) consumers.fetch_add(1);
+
+    perform_test(t, "PRODUCE/CONSUME",
+                 "allocate on the main thread, free on the others", [&]() {
+                     allocator alloc;
+                     for (size_t r = 0; r < rounds; ++r)
+                     {
+                         t.synchronize();
+                         if constexpr (ThreadType::is_main)
+                         {
+                             current_block.store(0);
+                             for (auto& ptr : items) ptr = alloc.allocate(1);
+                         }
+                         t.synchronize();
+                         if constexpr (!ThreadType::is_main)
+                             ttm::execute_parallel(
+                                 current_block, m, [&](size_t i) {
+                                     alloc.deallocate(items[i], 1);
+                                 });
+                         t.synchronize();
+                         if constexpr (ThreadType::is_main)
+                             if (!consumers.load())
+                                 for (auto ptr : items)
+                                     alloc.deallocate(ptr, 1);
+                     }
+                     return 0;
+                 });
+
+    // without handing over the free lists, each round would need m new
+    // chunks (rounds * m / per_slab slabs)
+    perform_test(t, "CHECK SLABS", "the number of slabs is bounded", [&]() {
+        size_t err = 0;
+        if constexpr (ThreadType::is_main)
+        {
+            // live chunks, one free list per thread, and partial slabs
+            auto bound = m / per_slab + 2 * (consumers.load() + 2);
+            if (allocator::num_slabs() > bound) err++;
+        }
+        errors.fetch_add(err, std::memory_order_relaxed);
+        return 0;
+    });
+}
+
+// INPUT  nothing (own table, it grows while the elements are inserted)
+// OUTPUT nothing
+template <class TableType, class ThreadType>
+void complex_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "COMPLEX TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<TableType>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting n string keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (!hash.insert(std::to_string(keys[i]), i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (i % 2 && hash.erase(std::to_string(keys[i])) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        // the erased elements are retired, they must not be freed while the
+        // found ones are read
+        perform_test(
+            t, "FIND BATCH", "look for all n keys in batches", [&]() {
+                size_t                   err = 0;
+                std::vector<std::string> skeys;
+                ttm::execute_blockwise_parallel(
+                    current_block, n, [&](size_t s, size_t e) {
+                        skeys.clear();
+                        for (size_t i = s; i < e; ++i)
+                            skeys.push_back(std::to_string(keys[i]));
+                        auto found = hash.find_batch(
+                            std::span<const std::string>(skeys),
+                            [&](size_t j, auto it) {
+                                if ((s + j) % 2)
+                                {
+                                    if (it != hash.end()) err++;
+                                }
+                                else if (it == hash.end() ||
+                                         (*it).second != s + j)
+                                    err++;
+                            });
+                        if (found != (e + 1) / 2 - (s + 1) / 2) err++;
+                    });
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+
+        perform_test(t, "UPDATE", "every thread increments all n keys",
+                     [&]() {
+                         size_t err = 0;
+                         for (size_t i = 0; i < n; ++i)
+                         {
+                             auto ret =
+                                 hash.update(std::to_string(keys[i]),
+                                             growt::example::Increment(), 1);
+                             if (ret.second != !(i % 2)) err++;
+                         }
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(t, "CHECK UPDATE", "no increment may be lost", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                auto it = hash.find(std::to_string(keys[i]));
+                if (i % 2 == 0 && (it == hash.end() || (*it).second != i + t.p))
+                    err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        // iterators decode the slots without knowing the key beforehand
+        perform_test(t, "CHECK ITERATION", "iterate over all elements", [&]() {
+            size_t err = 0;
+            if constexpr (ThreadType::is_main)
+            {
+                size_t count = 0;
+                for (auto it = hash.begin(); it != hash.end(); ++it)
+                {
+                    ++count;
+                    auto fit = hash.find((*it).first);
+                    if (fit == hash.end() || (*fit).second != (*it).second)
+                        err++;
+                }
+                if (count != (n + 1) / 2) err++;
+            }
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<TableType>(t);
+}
+
+// INPUT  nothing (own table, it grows while the elements are found)
+// OUTPUT nothing
+template <class ThreadType> void nohelp_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "NOHELP TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<nohelp_table_type>(t, n / 4);
+    {
+        auto        hash  = table.get_handle();
+        const auto& chash = hash;
+        perform_test(
+            t, "+INSERTION", "insert 2*n elements and find them (migrating)",
+            [&]() {
+                size_t err = 0;
+                ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                    if (!hash.insert(keys[i], i).second) err++;
+                    auto it = hash.find(keys[i]);
+                    if (it == hash.end() || (*it).second != i) err++;
+                });
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+
+        perform_test(t, "CONST FIND", "find all 2*n elements (const handle)",
+                     [&]() {
+                         size_t err = 0;
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 auto it = chash.find(keys[i]);
+                                 if (it == chash.cend() || (*it).second != i)
+                                     err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+    }
+    destroy_table<nohelp_table_type>(t);
+}
+
+// INPUT  nothing (own table, it grows while the elements are inserted)
+// OUTPUT nothing
+template <class TableType, class ThreadType, class KeyFct>
+void set_test(ThreadType& t, size_t n, KeyFct key)
+{
+    t.out << otm::color::bblue << "SET TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<TableType>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting 2*n keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(key(i), {}).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "INSERTION", "reinserting the first n keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (hash.insert(key(i), {}).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (i % 2 && hash.erase(key(i)) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "CHECK SET", "find all keys and iterate", [&]() {
+            size_t err = 0;
+            if constexpr (ThreadType::is_main)
+            {
+                size_t count = 0;
+                for (auto it = hash.begin(); it != hash.end(); ++it) ++count;
+                if (count != n) err++;
+            }
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto found = hash.find(key(i)) != hash.end();
+                if (found == bool(i % 2)) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<TableType>(t);
+}
+
+// INPUT  nothing (own table, it grows while the elements are inserted)
+// OUTPUT nothing
+template <class ThreadType> void filter_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "FILTER TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<filter_table_type>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting the first n keys", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (!hash.insert(keys[i], i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        // erased keys stay in the filter, they are found absent by probing
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, n, [&](size_t i) {
+                if (i % 2 && hash.erase(keys[i]) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "CHECK FILTER",
+                     "find all 2*n keys (the second n were never inserted)",
+                     [&]() {
+                         size_t err = 0;
+                         if constexpr (ThreadType::is_main)
+                         {
+                             // the filter is sized for the table and only
+                             // fills a small part of each word
+                             auto rate = hash.filter_false_positive_rate();
+                             if (rate <= 0. || rate > .1) err++;
+                             if (hash.filter_memory() == 0) err++;
+                         }
+                         ttm::execute_parallel(
+                             current_block, 2 * n, [&](size_t i) {
+                                 auto it = hash.find(keys[i]);
+                                 if (i < n && i % 2 == 0 &&
+                                     (it == hash.end() || (*it).second != i))
+                                     err++;
+                                 if ((i >= n || i % 2) && it != hash.end())
+                                     err++;
+                             });
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        // the deleted dummies trigger same-size migrations (purges with
+        // hmod::sync), they have to drop the erased keys from the filter
+        perform_test(t, "CHURN", "insert and delete 8*n new keys", [&]() {
+            size_t err = 0;
+            for (size_t r = 1; r <= 8; ++r)
+            {
+                t.synchronize();
+                if constexpr (ThreadType::is_main) current_block.store(0);
+                t.synchronize();
+                ttm::execute_parallel(current_block, n, [&](size_t i) {
+                    auto k = (keys[i] ^ (r * 0x5851F42D4C957F2Dull)) & range;
+                    if (!hash.insert(k, i).second) err++;
+                    if (hash.erase(k) != 1) err++;
+                });
+            }
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "CHECK CHURN", "the filter has to stay sparse", [&]() {
+            size_t err = 0;
+            if constexpr (ThreadType::is_main)
+                if (hash.filter_false_positive_rate() > .1) err++;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto it = hash.find(keys[i]);
+                if (i < n && i % 2 == 0 && it == hash.end()) err++;
+                if ((i >= n || i % 2) && it != hash.end()) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<filter_table_type>(t);
+}
+
+// INPUT  nothing (own table, it grows while the elements are inserted)
+// OUTPUT nothing
+template <class ThreadType> void packed_test(ThreadType& t, size_t n)
+{
+    t.out << otm::color::bblue << "PACKED TEST" << otm::color::reset
+          << std::endl;
+    auto& table = create_table<packed_table_type>(t, n / 4);
+    {
+        auto hash = table.get_handle();
+        perform_test(t, "+INSERTION", "inserting keys 1..2*n", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (!hash.insert(i + 1, i).second) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "+ERASE", "delete every second key", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                if (i % 2 && hash.erase(i + 1) != 1) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+
+        perform_test(t, "UPDATE", "every thread increments all 2*n keys",
+                     [&]() {
+                         size_t err = 0;
+                         for (size_t i = 0; i < 2 * n; ++i)
+                         {
+                             auto ret = hash.update(
+                                 i + 1, growt::example::Increment(), 1);
+                             if (ret.second != !(i % 2)) err++;
+                         }
+                         errors.fetch_add(err, std::memory_order_relaxed);
+                         return 0;
+                     });
+
+        perform_test(t, "CHECK PACKED", "find all keys check data", [&]() {
+            size_t err = 0;
+            ttm::execute_parallel(current_block, 2 * n, [&](size_t i) {
+                auto it = hash.find(i + 1);
+                if (i % 2 == 0 && (it == hash.end() || (*it).second != i + t.p))
+                    err++;
+                if (i % 2 && it != hash.end()) err++;
+            });
+            errors.fetch_add(err, std::memory_order_relaxed);
+            return 0;
+        });
+    }
+    destroy_table<packed_table_type>(t);
+}
+
+// INPUT  nothing (own table with a low-water mark)
+// OUTPUT nothing
+template <class ThreadType> void quotient_test(ThreadType& t, size_t n)
+{
+    // the hashes of the crafted keys differ only below their top 11 bits,
+    // i.e., they share their home slot in tables with up to 2048 slots (their
+    // displacements do not fit), larger tables split them
+    constexpr size_t   n_crafted = 255;
+    constexpr uint64_t prefix    = 0x2aa;
+    static uint64_t    crafted[n_crafted];
+
+    // the other keys (i+1) avoid the cluster of the crafted keys, otherwise
+    // their displacements would let the table grow
+    auto regular = [](size_t i) {
+        return (growt::quotient_hash<40>{}(i + 1) >> 53) - prefix > 10;
+    };
+
+    t.out << otm::color::bblue << "QUOTIENT TEST" << otm::color::reset
+          << std::endl;
+    if constexpr (estrat == hmod::incremental)
+    {
+        // incremental migrations cannot replace their target
+        t.out << "  skipped (incremental migration)" << std::endl << std::endl;
+    }
+    else
+    {
+        auto& table = create_table<quotient_table_type>(t, 0, 0.1);
+        {
+            auto hash = table.get_handle();
+            perform_test(
+                t, "+INSERTION", "inserting n keys and 255 crafted keys",
+                [&]() {
+                    size_t err = 0;
+                    if constexpr (ThreadType::is_main)
+                    {
+                        growt::quotient_hash<40> hf;
+                        for (size_t j = 0; j < n_crafted; ++j)
+                        {
+                            uint64_t h = (prefix << 53) | (uint64_t(j) << 45);
+                            crafted[j] = hf.inverse(h);
+                            if (hf(crafted[j]) != h || crafted[j] <= n) err++;
+                            if (!hash.insert(crafted[j], j).second) err++;
+                        }
+                    }
+                    ttm::execute_parallel(current_block, n, [&](size_t i) {
+                        if (regular(i) && !hash.insert(i + 1, i).second)
+                            err++;
+                    });
+                    errors.fetch_add(err, std::memory_order_relaxed);
+                    return 0;
+                });
+
+            // the last shrinking migration cannot store all displacements of
+            // the crafted keys, its target is replaced by a larger one
+            perform_test(
+                t, "+ERASE", "delete the n keys (the table shrinks)", [&]() {
+                    size_t err = 0;
+                    ttm::execute_parallel(current_block, n, [&](size_t i) {
+                        if (regular(i) && hash.erase(i + 1) != 1) err++;
+                    });
+                    errors.fetch_add(err, std::memory_order_relaxed);
+                    return 0;
+                });
+
+            perform_test(t, "CHECK QUOTIENT", "find the crafted keys", [&]() {
+                size_t err = 0;
+                if constexpr (ThreadType::is_main)
+                {
+                    for (size_t j = 0; j < n_crafted; ++j)
+                    {
+                        auto it = hash.find(crafted[j]);
+                        if (it == hash.end() || (*it).second != j) err++;
+                    }
+                }
+                ttm::execute_parallel(current_block, n, [&](size_t i) {
+                    if (hash.find(i + 1) != hash.end()) err++;
+                });
+                errors.fetch_add(err, std::memory_order_relaxed);
+                return 0;
+            });
+        }
+        destroy_table<quotient_table_type>(t);
+    }
+}
+
 template <class ThreadType> struct test_in_stages
 {
     static int execute(ThreadType t, size_t n, size_t it)
@@ -526,6 +1811,26 @@ template <class ThreadType> struct test_in_stages
             update_test(t, hash, n);
             operator_test(t, hash, n);
             range_iterator_test(t, hash, n);
+            batch_test(t, hash, n);
+            hash_batch_test(t, n);
+            build_test(t, n);
+            shrink_test(t, n);
+            purge_test(t, n);
+            scheduler_test(t, n);
+            reserve_test(t, n);
+            health_test(t, n);
+            complex_test<string_table_type>(t, n);
+            complex_test<inplace_table_type>(t, n);
+            complex_test<stored_hash_table_type>(t, n);
+            slab_test(t);
+            set_test<set_table_type>(t, n, [](size_t i) { return keys[i]; });
+            set_test<string_set_table_type>(
+                t, n, [](size_t i) { return std::to_string(keys[i]); });
+            filter_test(t, n);
+            packed_test(t, n);
+            quotient_test(t, n);
+            nohelp_test(t, n);
+            trace_test(t, n);
 
             t.out << std::endl;
         }
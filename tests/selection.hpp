@@ -34,6 +34,11 @@ using allocator_type = growt::PoolAllocator<>;
 using allocator_type = growt::NUMAPoolAllocator<>;
 #endif
 
+#ifdef NUMA_PARTITIONED
+#include "allocator/numapartitionedallocator.hpp"
+using allocator_type = growt::NUMAPartitionedAllocator<>;
+#endif
+
 #ifdef HTLB_POOL
 #include "allocator/poolallocator.hpp"
 using allocator_type = growt::HTLBPoolAllocator<>;
@@ -62,7 +67,8 @@ using table_config =
 
 
 #if defined(FOLKLORE) || defined(UAGROW) || defined(USGROW) || \
-    defined(PAGROW) || defined(PSGROW)
+    defined(PAGROW) || defined(PSGROW) || defined(UIGROW) ||  \
+    defined(SAGROW) || defined(SSGROW)
 #include "data-structures/table_config.hpp"
 #if defined(FOLKLORE)
 constexpr hmod dynamic = hmod::neutral;
@@ -71,11 +77,15 @@ constexpr hmod dynamic = hmod::growable;
 #endif
 #if defined(PAGROW) || defined(PSGROW)
 constexpr hmod wstrat = hmod::pool;
+#elif defined(SAGROW) || defined(SSGROW)
+constexpr hmod wstrat = hmod::shared_pool;
 #else // UXGROW
 constexpr hmod wstrat  = hmod::neutral;
 #endif
-#if defined(USGROW) || defined(PSGROW)
+#if defined(USGROW) || defined(PSGROW) || defined(SSGROW)
 constexpr hmod estrat = hmod::sync;
+#elif defined(UIGROW)
+constexpr hmod estrat = hmod::incremental;
 #else // XSGROW
 constexpr hmod estrat  = hmod::neutral;
 #endif
@@ -92,10 +102,22 @@ constexpr hmod cprob = hmod::circular_prob;
 constexpr hmod cprob   = hmod::neutral;
 #endif
 
+#if defined(TAGS)
+constexpr hmod tags = hmod::tag_probing;
+#else
+constexpr hmod tags    = hmod::neutral;
+#endif
+
+#if defined(BOUND)
+constexpr hmod bound = hmod::bounded_probing;
+#else
+constexpr hmod bound   = hmod::neutral;
+#endif
+
 template <class Key, class Data, class HashFct, class Alloc, hmod... Mods>
 using table_config =
     typename growt::table_config<Key, Data, HashFct, Alloc, dynamic, estrat,
-                                 wstrat, cmap, cprob, Mods...>;
+                                 wstrat, cmap, cprob, tags, bound, Mods...>;
 #endif
 
 